@@ -0,0 +1,82 @@
+#include "benchreport.h"
+#include "appversion.h"
+#include <QXmlStreamReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QThread>
+#include <QFile>
+#include <QDebug>
+
+BenchReport::BenchReport(const QString &_path, const QString &_logDir)
+    : path(_path),
+      logDir(_logDir)
+{
+}
+
+QString BenchReport::logPath(const QString &name) const {
+    return logDir + "/" + name + ".xml";
+}
+
+QStringList BenchReport::arguments(QStringList args, const QString &name) const {
+    if(!args.contains("-o"))
+        args << "-o" << "-,txt";
+    args << "-o" << logPath(name) + ",xml";
+    return args;
+}
+
+void BenchReport::collect(const QString &name) {
+    QFile file(logPath(name));
+    if(!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "[BenchReport] no results for" << name;
+        failures << name;
+        return;
+    }
+    QXmlStreamReader xml(&file);
+    QString function;
+    while(!xml.atEnd()) {
+        if(xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+        auto attr = xml.attributes();
+        if(xml.name() == QLatin1String("TestFunction")) {
+            function = name + "::" + attr.value("name").toString();
+        } else if(xml.name() == QLatin1String("BenchmarkResult")) {
+            // value is the total over all iterations
+            int iterations = qMax(1, attr.value("iterations").toInt());
+            QJsonObject result;
+            result["name"] = function;
+            result["tag"] = attr.value("tag").toString();
+            result["metric"] = attr.value("metric").toString();
+            result["value"] = attr.value("value").toDouble() / iterations;
+            result["iterations"] = iterations;
+            results.append(result);
+        } else if(xml.name() == QLatin1String("Incident")) {
+            auto type = attr.value("type");
+            if(type == QLatin1String("fail") || type == QLatin1String("xpass"))
+                failures << function;
+        }
+    }
+    if(xml.hasError())
+        qDebug() << "[BenchReport]" << file.fileName() << xml.errorString();
+}
+
+bool BenchReport::write() const {
+    QJsonObject root;
+    root["qimgv"] = appVersion.toString();
+    root["qt"] = QString(qVersion());
+    root["os"] = QSysInfo::prettyProductName();
+    root["cpu"] = QSysInfo::currentCpuArchitecture();
+    root["threads"] = QThread::idealThreadCount();
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["results"] = results;
+    root["failures"] = QJsonArray::fromStringList(failures);
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "[BenchReport] could not open" << path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    qDebug() << "[BenchReport]" << results.count() << "results written to" << path;
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QJsonArray>
+
+// Collects QBENCHMARK results into a json file, for comparing releases.
+//
+// Each benchmark class is run with an extra xml log (QTest has no json one),
+// which is read back after the run:
+//     args = report.arguments(args, "ImageBench");
+//     QTest::qExec(&bench, args);
+//     report.collect("ImageBench");
+//     ...
+//     report.write();
+class BenchReport {
+public:
+    BenchReport(const QString &path, const QString &logDir);
+    // adds the xml log for this class; keeps the console output
+    QStringList arguments(QStringList args, const QString &name) const;
+    void collect(const QString &name);
+    bool write() const;
+
+private:
+    QString path, logDir;
+    QJsonArray results;
+    QStringList failures;
+    QString logPath(const QString &name) const;
+};
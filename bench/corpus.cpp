@@ -0,0 +1,98 @@
+#include "corpus.h"
+#include <QRandomGenerator>
+#include <QImageWriter>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+
+#define DEFAULT_DIRECTORY_SIZES "10000,100000"
+
+namespace Corpus {
+
+QImage photo(QSize size, quint32 seed) {
+    QImage image(size, QImage::Format_RGB32);
+    QRandomGenerator rng(seed);
+    int width = size.width(), height = size.height();
+    for(int y = 0; y < height; y++) {
+        auto line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for(int x = 0; x < width; x++) {
+            int noise = static_cast<int>(rng.bounded(16));
+            line[x] = qRgb((x * 255 / width + noise) & 0xFF,
+                           (y * 255 / height + noise) & 0xFF,
+                           ((x + y) / 32 + noise) & 0xFF);
+        }
+    }
+    return image;
+}
+
+QString writeImage(const QString &dir, QSize size, const QString &format) {
+    if(!QImageWriter::supportedImageFormats().contains(format.toLatin1()))
+        return QString();
+    QString path = QString("%1/%2x%3.%4").arg(dir).arg(size.width()).arg(size.height()).arg(format);
+    QImageWriter writer(path, format.toLatin1());
+    writer.setQuality(90);
+    if(!writer.write(photo(size)))
+        return QString();
+    return path;
+}
+
+QStringList writeFileNames(const QString &dir, int count, quint32 seed) {
+    QRandomGenerator rng(seed);
+    // 2020-01-01, utc so that no two names collide around dst changes
+    QDateTime base = QDateTime::fromSecsSinceEpoch(1577836800).toUTC();
+    QStringList names;
+    names.reserve(count);
+    for(int i = 0; i < count; i++) {
+        // unique for every i
+        QDateTime shot = base.addSecs(i * 7);
+        QString name;
+        switch(rng.bounded(10)) {
+        case 0:
+        case 1:
+        case 2:
+            name = "IMG_" + shot.toString("yyyyMMdd_HHmmss") + ".jpg";
+            break;
+        case 3:
+            name = "PXL_" + shot.toString("yyyyMMdd_HHmmsszzz") + ".jpg";
+            break;
+        case 4:
+            name = QString("DSC_%1.JPG").arg(i, 6, 10, QChar('0'));
+            break;
+        case 5:
+            name = "Screenshot from " + shot.toString("yyyy-MM-dd HH-mm-ss") + ".png";
+            break;
+        case 6:
+            name = QString("photo (%1).webp").arg(i);
+            break;
+        case 7:
+            name = QString("reaction_%1.gif").arg(i);
+            break;
+        case 8:
+            name = "IMG_" + shot.toString("yyyyMMdd_HHmmss") + ".CR2.xmp";
+            break;
+        default:
+            name = QString("notes %1.txt").arg(i);
+            break;
+        }
+        QFile file(dir + "/" + name);
+        if(!file.open(QIODevice::WriteOnly))
+            continue;
+        // unrelated to the name order, so that sorting by time does some work
+        file.setFileTime(base.addSecs(rng.bounded(3 * 365 * 24 * 3600)), QFileDevice::FileModificationTime);
+        names << name;
+    }
+    return names;
+}
+
+QList<int> directorySizes() {
+    QString env = qEnvironmentVariable("QIMGV_BENCH_FILES", DEFAULT_DIRECTORY_SIZES);
+    QList<int> sizes;
+    for(auto &str : env.split(',')) {
+        int size = str.trimmed().toInt();
+        if(size > 0)
+            sizes << size;
+    }
+    return sizes;
+}
+
+} // namespace Corpus
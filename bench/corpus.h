@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QSize>
+
+// Deterministic test data, generated offline.
+// The same seed always gives the same pixels / file names.
+namespace Corpus {
+    // smooth gradients with some noise, roughly like a photo compresses
+    QImage photo(QSize size, quint32 seed = 1);
+
+    // saves photo(size) as dir/<width>x<height>.<format>;
+    // returns the path, or an empty string if the format can't be written
+    QString writeImage(const QString &dir, QSize size, const QString &format);
+
+    // Creates count empty files with camera, phone and screenshot style names
+    // (and some sidecar / unsupported ones), with spread out modification times.
+    // Returns the file names.
+    QStringList writeFileNames(const QString &dir, int count, quint32 seed = 1);
+
+    // file counts for directory benchmarks,
+    // from QIMGV_BENCH_FILES (e.g. "10000,100000,500000")
+    QList<int> directorySizes();
+}
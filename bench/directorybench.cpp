@@ -0,0 +1,175 @@
+#include "directorybench.h"
+#include "corpus.h"
+#include "components/directorymanager/directorymanager.h"
+#include "components/directorymanager/directorysnapshot.h"
+#include "components/directorymanager/extensionfilter.h"
+#include "settings.h"
+#include <QRegularExpression>
+#include <QEventLoop>
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+
+// for the watcher to deliver all changes
+#define WATCHER_TIMEOUT 10000 // ms
+
+void DirectoryBench::initTestCase() {
+    QVERIFY(root.isValid());
+    for(int count : Corpus::directorySizes()) {
+        QString path = root.path() + "/" + QString::number(count);
+        QVERIFY(QDir().mkpath(path));
+        Corpus::writeFileNames(path, count);
+        dirs.insert(count, path);
+    }
+    QVERIFY(!dirs.isEmpty());
+}
+
+// snapshots live in the shared cache dir
+void DirectoryBench::cleanupTestCase() {
+    DirectorySnapshot snapshot;
+    for(auto &path : dirs)
+        snapshot.remove(path);
+}
+
+void DirectoryBench::addDirs() {
+    QTest::addColumn<QString>("path");
+    for(auto it = dirs.constBegin(); it != dirs.constEnd(); ++it)
+        QTest::newRow(QString("%1 files").arg(it.key()).toLatin1().constData()) << it.value();
+}
+
+bool DirectoryBench::waitForFileCount(DirectoryManager &dm, unsigned long count) {
+    if(dm.fileCount() == count)
+        return true;
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    auto check = [&]() {
+        if(dm.fileCount() == count)
+            loop.quit();
+    };
+    connect(&dm, &DirectoryManager::fileAdded, &loop, check);
+    connect(&dm, &DirectoryManager::fileRemoved, &loop, check);
+    connect(&dm, &DirectoryManager::bulkChanged, &loop, check);
+    timeout.start(WATCHER_TIMEOUT);
+    loop.exec();
+    return dm.fileCount() == count;
+}
+
+void DirectoryBench::setDirectoryCold_data() {
+    addDirs();
+}
+
+void DirectoryBench::setDirectoryCold() {
+    QFETCH(QString, path);
+    DirectoryManager dm;
+    DirectorySnapshot snapshot;
+    QBENCHMARK {
+        snapshot.remove(path);
+        dm.setDirectory(path);
+    }
+    QVERIFY(dm.fileCount() > 0);
+}
+
+void DirectoryBench::setDirectoryWarm_data() {
+    addDirs();
+}
+
+void DirectoryBench::setDirectoryWarm() {
+    QFETCH(QString, path);
+    DirectoryManager dm;
+    dm.setDirectory(path);
+    unsigned long count = dm.fileCount();
+    QBENCHMARK {
+        dm.setDirectory(path);
+    }
+    QCOMPARE(dm.fileCount(), count);
+}
+
+void DirectoryBench::sort_data() {
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<int>("mode");
+    QMap<QString, SortingMode> modes = {
+        { "name desc", SORT_NAME_DESC },
+        { "size", SORT_SIZE },
+        { "time", SORT_TIME },
+        { "time desc", SORT_TIME_DESC },
+    };
+    for(auto it = dirs.constBegin(); it != dirs.constEnd(); ++it) {
+        for(auto mode = modes.constBegin(); mode != modes.constEnd(); ++mode) {
+            QTest::newRow(QString("%1 files, %2").arg(it.key()).arg(mode.key()).toLatin1().constData())
+                    << it.value() << static_cast<int>(mode.value());
+        }
+    }
+}
+
+// to the given mode and back to name
+void DirectoryBench::sort() {
+    QFETCH(QString, path);
+    QFETCH(int, mode);
+    DirectoryManager dm;
+    dm.setSortingMode(SORT_NAME);
+    dm.setDirectory(path);
+    QBENCHMARK {
+        dm.setSortingMode(static_cast<SortingMode>(mode));
+        dm.setSortingMode(SORT_NAME);
+    }
+}
+
+void DirectoryBench::filter_data() {
+    QTest::addColumn<bool>("regex");
+    QTest::newRow("regex") << true;
+    QTest::newRow("extension set") << false;
+}
+
+// all paths of the smallest directory
+void DirectoryBench::filter() {
+    QFETCH(bool, regex);
+    QString dirPath = dirs.first();
+    QStringList paths;
+    for(auto const &name : QDir(dirPath).entryList(QDir::Files))
+        paths << dirPath + "/" + name;
+    QRegularExpression re(settings->supportedFormatsRegex(), QRegularExpression::CaseInsensitiveOption);
+    ExtensionFilter extensionFilter;
+    extensionFilter.setFormats(settings->snapshot()->supportedFormats);
+    int matched = 0;
+    QBENCHMARK {
+        matched = 0;
+        if(regex) {
+            for(auto const &path : paths)
+                matched += re.match(path).hasMatch();
+        } else {
+            for(auto const &path : paths)
+                matched += extensionFilter.matches(path);
+        }
+    }
+    QVERIFY(matched > 0);
+}
+
+void DirectoryBench::watcherBurst_data() {
+    QTest::addColumn<int>("burst");
+    for(int burst : { 10, 100, 1000 })
+        QTest::newRow(QString("%1 files").arg(burst).toLatin1().constData()) << burst;
+}
+
+// in the smallest directory
+void DirectoryBench::watcherBurst() {
+    QFETCH(int, burst);
+    QString path = dirs.first();
+    DirectoryManager dm;
+    dm.setDirectory(path);
+    if(!dm.fileWatcherActive())
+        QSKIP("no directory watcher on this platform");
+    unsigned long count = dm.fileCount();
+    QStringList burstFiles;
+    for(int i = 0; i < burst; i++)
+        burstFiles << QString("%1/burst_%2.jpg").arg(path).arg(i, 5, 10, QChar('0'));
+    QBENCHMARK {
+        for(auto &file : burstFiles)
+            QVERIFY(QFile(file).open(QIODevice::WriteOnly));
+        QVERIFY(waitForFileCount(dm, count + static_cast<unsigned long>(burst)));
+        for(auto &file : burstFiles)
+            QFile::remove(file);
+        QVERIFY(waitForFileCount(dm, count));
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QMap>
+
+class DirectoryManager;
+
+// DirectoryManager on directories of empty files with realistic names.
+//  - setDirectoryCold: no saved listing, full scan + sort
+//  - setDirectoryWarm: listing served from the snapshot
+//                      (the background rescan it starts is not measured)
+//  - sort:             switching the sorting mode
+//  - filter:           ExtensionFilter vs the supported formats regex it replaced
+//  - watcherBurst:     files created, then deleted by another program,
+//                      until the lists are up to date
+class DirectoryBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void setDirectoryCold_data();
+    void setDirectoryCold();
+    void setDirectoryWarm_data();
+    void setDirectoryWarm();
+
+    void sort_data();
+    void sort();
+
+    void filter_data();
+    void filter();
+
+    void watcherBurst_data();
+    void watcherBurst();
+
+private:
+    QTemporaryDir root;
+    // file count -> path
+    QMap<int, QString> dirs;
+    void addDirs();
+    bool waitForFileCount(DirectoryManager &dm, unsigned long count);
+};
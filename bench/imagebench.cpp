@@ -0,0 +1,77 @@
+#include "imagebench.h"
+#include "corpus.h"
+#include "utils/imagefactory.h"
+#include "utils/imagelib.h"
+
+// scaling target, a typical viewer window
+#define VIEWPORT QSize(1280, 720)
+
+namespace {
+
+const QList<QSize> sizes = { QSize(800, 600), QSize(1920, 1080), QSize(4000, 3000) };
+const QStringList formats = { "jpg", "png", "webp" };
+
+QString sizeName(QSize size) {
+    return QString("%1x%2").arg(size.width()).arg(size.height());
+}
+
+} // namespace
+
+void ImageBench::initTestCase() {
+    QVERIFY(dir.isValid());
+    for(auto size : sizes) {
+        for(auto &format : formats) {
+            QString path = Corpus::writeImage(dir.path(), size, format);
+            if(path.isEmpty())
+                qDebug() << "[ImageBench] skipping" << format << "- no image writer";
+            else
+                files.insert(format + " " + sizeName(size), path);
+        }
+        images.insert(sizeName(size), std::make_shared<const QImage>(Corpus::photo(size)));
+    }
+}
+
+void ImageBench::createImage_data() {
+    QTest::addColumn<QString>("path");
+    for(auto it = files.constBegin(); it != files.constEnd(); ++it)
+        QTest::newRow(it.key().toLatin1().constData()) << it.value();
+}
+
+void ImageBench::createImage() {
+    QFETCH(QString, path);
+    auto image = ImageFactory::createImage(path);
+    QVERIFY(image && image->isLoaded());
+    QBENCHMARK {
+        image = ImageFactory::createImage(path);
+    }
+}
+
+void ImageBench::scaled_data() {
+    QTest::addColumn<QString>("image");
+    QTest::addColumn<int>("filter");
+    QMap<QString, ScalingFilter> filters = {
+        { "nearest", QI_FILTER_NEAREST },
+        { "bilinear", QI_FILTER_BILINEAR },
+#ifdef USE_OPENCV
+        { "cv bilinear sharpen", QI_FILTER_CV_BILINEAR_SHARPEN },
+        { "cv cubic", QI_FILTER_CV_CUBIC },
+        { "cv cubic sharpen", QI_FILTER_CV_CUBIC_SHARPEN },
+#endif
+    };
+    for(auto it = filters.constBegin(); it != filters.constEnd(); ++it) {
+        for(auto &image : images.keys()) {
+            QTest::newRow((it.key() + " " + image).toLatin1().constData())
+                    << image << static_cast<int>(it.value());
+        }
+    }
+}
+
+void ImageBench::scaled() {
+    QFETCH(QString, image);
+    QFETCH(int, filter);
+    auto source = images[image];
+    QSize target = source->size().scaled(VIEWPORT, Qt::KeepAspectRatio);
+    QBENCHMARK {
+        std::unique_ptr<QImage> result(ImageLib::scaled(source, target, static_cast<ScalingFilter>(filter)));
+    }
+}
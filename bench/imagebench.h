@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QImage>
+#include <QMap>
+#include <memory>
+
+// ImageFactory::createImage and ImageLib::scaled
+// on synthetic photos of several formats and sizes.
+class ImageBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void createImage_data();
+    void createImage();
+
+    void scaled_data();
+    void scaled();
+
+private:
+    QTemporaryDir dir;
+    // "jpg 1920x1080" -> path
+    QMap<QString, QString> files;
+    QMap<QString, std::shared_ptr<const QImage>> images;
+};
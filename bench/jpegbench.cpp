@@ -0,0 +1,152 @@
+#include "jpegbench.h"
+#include "utils/jpegdecoder.h"
+#include <QImage>
+#include <QImageReader>
+#include <QBuffer>
+#include <QRandomGenerator>
+#include <cstdlib>
+#include <jpeglib.h>
+
+// 24MP, a typical camera photo
+#define IMAGE_WIDTH  6000
+#define IMAGE_HEIGHT 4000
+// a viewport-sized part of it
+#define REGION       QRect(2500, 1500, 1920, 1080)
+
+namespace {
+
+// Smooth gradients with some noise, roughly like a photo compresses.
+QByteArray encodeJpeg(int width, int height, int restartRows) {
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr err;
+    cinfo.err = jpeg_std_error(&err);
+    jpeg_create_compress(&cinfo);
+    unsigned char *out = nullptr;
+    unsigned long size = 0;
+    jpeg_mem_dest(&cinfo, &out, &size);
+    cinfo.image_width = static_cast<JDIMENSION>(width);
+    cinfo.image_height = static_cast<JDIMENSION>(height);
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 90, TRUE);
+    cinfo.restart_in_rows = restartRows;
+    jpeg_start_compress(&cinfo, TRUE);
+    QByteArray row(width * 3, 0);
+    QRandomGenerator rng(1);
+    while(cinfo.next_scanline < cinfo.image_height) {
+        int y = static_cast<int>(cinfo.next_scanline);
+        auto p = reinterpret_cast<uchar*>(row.data());
+        for(int x = 0; x < width; x++) {
+            int noise = static_cast<int>(rng.bounded(16));
+            p[x * 3]     = static_cast<uchar>((x * 255 / width + noise) & 0xFF);
+            p[x * 3 + 1] = static_cast<uchar>((y * 255 / height + noise) & 0xFF);
+            p[x * 3 + 2] = static_cast<uchar>(((x + y) / 32 + noise) & 0xFF);
+        }
+        JSAMPROW rowPtr = p;
+        jpeg_write_scanlines(&cinfo, &rowPtr, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    QByteArray result(reinterpret_cast<const char*>(out), static_cast<int>(size));
+    free(out);
+    jpeg_destroy_compress(&cinfo);
+    return result;
+}
+
+QImage readQt(const QByteArray &data, QRect clip = QRect()) {
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, "jpg");
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    reader.setAllocationLimit(0);
+#endif
+    if(!clip.isNull())
+        reader.setClipRect(clip);
+    return reader.read();
+}
+
+} // namespace
+
+void JpegBench::initTestCase() {
+    files.insert("restart markers", encodeJpeg(IMAGE_WIDTH, IMAGE_HEIGHT, 1));
+    files.insert("plain", encodeJpeg(IMAGE_WIDTH, IMAGE_HEIGHT, 0));
+}
+
+void JpegBench::addFiles() {
+    QTest::addColumn<QString>("file");
+    for(auto &name : files.keys())
+        QTest::newRow(name.toLatin1().constData()) << name;
+}
+
+void JpegBench::parallelMatchesSerial_data() {
+    addFiles();
+}
+
+void JpegBench::parallelMatchesSerial() {
+    QFETCH(QString, file);
+    QImage serial, parallel, region;
+    QVERIFY(JpegDecoder::read(files[file], serial, QRect(), 1));
+    QVERIFY(JpegDecoder::read(files[file], parallel, QRect(), 0));
+    QVERIFY(JpegDecoder::read(files[file], region, REGION, 0));
+    QCOMPARE(parallel, serial);
+    QCOMPARE(region, serial.copy(REGION));
+}
+
+void JpegBench::qimagereader_data() {
+    addFiles();
+}
+
+void JpegBench::qimagereader() {
+    QFETCH(QString, file);
+    QBENCHMARK {
+        QImage image = readQt(files[file]);
+    }
+}
+
+void JpegBench::jpegdecoderSerial_data() {
+    addFiles();
+}
+
+void JpegBench::jpegdecoderSerial() {
+    QFETCH(QString, file);
+    QBENCHMARK {
+        QImage image;
+        JpegDecoder::read(files[file], image, QRect(), 1);
+    }
+}
+
+void JpegBench::jpegdecoderParallel_data() {
+    addFiles();
+}
+
+void JpegBench::jpegdecoderParallel() {
+    QFETCH(QString, file);
+    QBENCHMARK {
+        QImage image;
+        JpegDecoder::read(files[file], image);
+    }
+}
+
+void JpegBench::qimagereaderRegion_data() {
+    addFiles();
+}
+
+void JpegBench::qimagereaderRegion() {
+    QFETCH(QString, file);
+    QBENCHMARK {
+        QImage image = readQt(files[file], REGION);
+    }
+}
+
+void JpegBench::jpegdecoderRegion_data() {
+    addFiles();
+}
+
+void JpegBench::jpegdecoderRegion() {
+    QFETCH(QString, file);
+    QBENCHMARK {
+        QImage image;
+        JpegDecoder::read(files[file], image, REGION);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+#include <QByteArray>
+#include <QMap>
+
+// JpegDecoder vs QImageReader on synthetic photos,
+// with and without restart markers.
+class JpegBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void parallelMatchesSerial_data();
+    void parallelMatchesSerial();
+
+    void qimagereader_data();
+    void qimagereader();
+    void jpegdecoderSerial_data();
+    void jpegdecoderSerial();
+    void jpegdecoderParallel_data();
+    void jpegdecoderParallel();
+
+    void qimagereaderRegion_data();
+    void qimagereaderRegion();
+    void jpegdecoderRegion_data();
+    void jpegdecoderRegion();
+
+private:
+    QMap<QString, QByteArray> files;
+    void addFiles();
+};
@@ -0,0 +1,63 @@
+#include <QApplication>
+#include <QTest>
+#include <QTemporaryDir>
+#include "settings.h"
+#include "benchreport.h"
+#include "imagebench.h"
+#include "thumbnailbench.h"
+#include "directorybench.h"
+#ifdef USE_LIBJPEG_TURBO
+#include "jpegbench.h"
+#endif
+
+// Runs every benchmark class; arguments are passed to each QTest::qExec().
+// Extra options:
+//     --json <file>    also write all results to file
+int main(int argc, char *argv[]) {
+    // no display needed
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    // config & caches go here instead of the user's
+    QTemporaryDir home;
+    qputenv("XDG_CONFIG_HOME", (home.path() + "/config").toUtf8());
+    qputenv("XDG_CACHE_HOME", (home.path() + "/cache").toUtf8());
+
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("qimgv");
+    QCoreApplication::setApplicationName("qimgv_bench");
+    settings = Settings::getInstance();
+
+    QStringList args = app.arguments();
+    QString jsonPath;
+    int jsonIndex = args.indexOf("--json");
+    if(jsonIndex > 0 && jsonIndex + 1 < args.count()) {
+        jsonPath = args.at(jsonIndex + 1);
+        args.erase(args.begin() + jsonIndex, args.begin() + jsonIndex + 2);
+    }
+    BenchReport report(jsonPath, home.path());
+
+    int status = 0;
+    auto run = [&](QObject *bench) {
+        QString name = bench->metaObject()->className();
+        if(jsonPath.isEmpty()) {
+            status |= QTest::qExec(bench, args);
+        } else {
+            status |= QTest::qExec(bench, report.arguments(args, name));
+            report.collect(name);
+        }
+    };
+#ifdef USE_LIBJPEG_TURBO
+    JpegBench jpegBench;
+    run(&jpegBench);
+#endif
+    ImageBench imageBench;
+    run(&imageBench);
+    ThumbnailBench thumbnailBench;
+    run(&thumbnailBench);
+    DirectoryBench directoryBench;
+    run(&directoryBench);
+
+    if(!jsonPath.isEmpty() && !report.write())
+        status |= 1;
+    return status;
+}
@@ -0,0 +1,59 @@
+#include "thumbnailbench.h"
+#include "corpus.h"
+#include "components/thumbnailer/thumbnailerrunnable.h"
+
+#define THUMBNAIL_SIZE 256
+
+namespace {
+
+const QList<QSize> sizes = { QSize(1920, 1080), QSize(4000, 3000) };
+const QStringList formats = { "jpg", "png", "webp" };
+
+} // namespace
+
+void ThumbnailBench::initTestCase() {
+    QVERIFY(dir.isValid());
+    cache.reset(new ThumbnailCache());
+    for(auto size : sizes) {
+        for(auto &format : formats) {
+            QString path = Corpus::writeImage(dir.path(), size, format);
+            if(!path.isEmpty())
+                files.insert(QString("%1 %2x%3").arg(format).arg(size.width()).arg(size.height()), path);
+        }
+    }
+}
+
+void ThumbnailBench::addFiles() {
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<bool>("crop");
+    for(auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        QTest::newRow(it.key().toLatin1().constData()) << it.value() << false;
+        QTest::newRow((it.key() + " crop").toLatin1().constData()) << it.value() << true;
+    }
+}
+
+void ThumbnailBench::generateCold_data() {
+    addFiles();
+}
+
+void ThumbnailBench::generateCold() {
+    QFETCH(QString, path);
+    QFETCH(bool, crop);
+    QBENCHMARK {
+        auto thumbnail = ThumbnailerRunnable::generate(cache.get(), path, THUMBNAIL_SIZE, crop, true);
+    }
+}
+
+void ThumbnailBench::generateWarm_data() {
+    addFiles();
+}
+
+void ThumbnailBench::generateWarm() {
+    QFETCH(QString, path);
+    QFETCH(bool, crop);
+    auto thumbnail = ThumbnailerRunnable::generate(cache.get(), path, THUMBNAIL_SIZE, crop, true);
+    QVERIFY(thumbnail && thumbnail->pixmap());
+    QBENCHMARK {
+        thumbnail = ThumbnailerRunnable::generate(cache.get(), path, THUMBNAIL_SIZE, crop, false);
+    }
+}
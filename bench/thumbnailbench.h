@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QMap>
+#include <memory>
+#include "components/cache/thumbnailcache.h"
+
+// ThumbnailerRunnable::generate on synthetic photos.
+//  - cold: thumbnail cache is bypassed, then written (first visit to a folder)
+//  - warm: thumbnail is read back from the cache
+// The os file cache is warm in both cases.
+class ThumbnailBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void generateCold_data();
+    void generateCold();
+    void generateWarm_data();
+    void generateWarm();
+
+private:
+    QTemporaryDir dir;
+    std::unique_ptr<ThumbnailCache> cache;
+    // "jpg 1920x1080" -> path
+    QMap<QString, QString> files;
+    void addFiles();
+};
@@ -1,4 +1,5 @@
 #include "actionmanager.h"
+#include "components/metrics/navigationmetrics.h"
 
 ActionManager *actionManager = nullptr;
 
@@ -225,6 +226,8 @@ const QList<QString> ActionManager::shortcutsForAction(QString action) {
 bool ActionManager::invokeAction(const QString &actionName) {
     ActionType type = validateAction(actionName);
     if(type == ActionType::ACTION_NORMAL) {
+        if(navMetrics)
+            navMetrics->actionTriggered();
         QMetaObject::invokeMethod(this, actionName.toLatin1().constData(), Qt::DirectConnection);
         return true;
     } else if(type == ActionType::ACTION_SCRIPT) {
@@ -0,0 +1,105 @@
+#include "animationdecoder.h"
+#include <algorithm>
+#include <climits>
+
+// memory for frames decoded ahead / kept as keyframes, in bytes
+#define AHEAD_BUDGET     (64 * 1024 * 1024)
+#define KEYFRAME_BUDGET  (128 * 1024 * 1024)
+#define AHEAD_MAX        8
+#define KEYFRAME_INTERVAL_MIN 16
+
+AnimationDecoder::AnimationDecoder(std::shared_ptr<QMovie> _movie, QObject *parent)
+    : QObject(parent),
+      movie(_movie)
+{
+    qint64 frameBytes = qMax(qint64(movie->frameRect().width()) * movie->frameRect().height() * 4, qint64(1));
+    state.device = movie->device();
+    state.format = movie->format();
+    state.frameCount = qMax(movie->frameCount(), 0);
+    state.aheadLimit = static_cast<int>(qBound(qint64(2), AHEAD_BUDGET / frameBytes, qint64(AHEAD_MAX)));
+    state.keyframeLimit = static_cast<int>(qMin(KEYFRAME_BUDGET / frameBytes, qint64(INT_MAX)));
+    // spread keyframes over the whole animation when the count is known
+    state.keyframeInterval = KEYFRAME_INTERVAL_MIN;
+    if(state.frameCount && state.keyframeLimit)
+        state.keyframeInterval = qMax(KEYFRAME_INTERVAL_MIN, (state.frameCount + state.keyframeLimit - 1) / state.keyframeLimit);
+    historySize = state.aheadLimit;
+
+    pool = new QThreadPool(this);
+    pool->setMaxThreadCount(1);
+    runnable = new AnimationDecoderRunnable(&state);
+    runnable->setAutoDelete(false);
+    connect(runnable, &AnimationDecoderRunnable::frameReady, this, &AnimationDecoder::frameReady, Qt::QueuedConnection);
+    connect(runnable, &AnimationDecoderRunnable::failed, this, &AnimationDecoder::decodingFailed, Qt::QueuedConnection);
+    pool->start(runnable);
+}
+
+AnimationDecoder::~AnimationDecoder() {
+    state.mutex.lock();
+    state.stop = true;
+    state.wake.wakeAll();
+    state.mutex.unlock();
+    pool->waitForDone();
+    delete runnable;
+}
+
+int AnimationDecoder::frameCount() {
+    QMutexLocker lock(&state.mutex);
+    return state.frameCount;
+}
+
+bool AnimationDecoder::takeFrame(int number, AnimationFrame &frame) {
+    QMutexLocker lock(&state.mutex);
+    int next = number + 1;
+    if(state.frameCount && next >= state.frameCount)
+        next = 0;
+    // decoded ahead
+    for(size_t i = 0; i < state.ahead.size(); i++) {
+        if(state.ahead[i].number == number) {
+            frame = state.ahead[i];
+            state.ahead.erase(state.ahead.begin(), state.ahead.begin() + static_cast<long>(i) + 1);
+            state.next = next;
+            state.pending = -1;
+            state.wake.wakeAll();
+            addToHistory(frame);
+            return true;
+        }
+    }
+    // anything else means a jump; queued frames are of no use
+    state.ahead.clear();
+    state.wake.wakeAll();
+    auto cached = std::find_if(history.begin(), history.end(), [number](const AnimationFrame &f) {
+        return f.number == number;
+    });
+    if(cached != history.end() || state.keyframes.contains(number)) {
+        frame = (cached != history.end()) ? *cached : state.keyframes.value(number);
+        state.next = next;
+        state.pending = -1;
+        addToHistory(frame);
+        return true;
+    }
+    state.next = number;
+    state.pending = number;
+    return false;
+}
+
+void AnimationDecoder::setTargetSize(QSize size, ScalingFilter filter) {
+    QMutexLocker lock(&state.mutex);
+    if(size == state.targetSize && filter == state.filter)
+        return;
+    state.targetSize = size;
+    state.filter = filter;
+    // worker rescales what's queued
+    state.wake.wakeAll();
+}
+
+void AnimationDecoder::addToHistory(const AnimationFrame &frame) {
+    for(auto it = history.begin(); it != history.end(); ++it) {
+        if(it->number == frame.number) {
+            history.erase(it);
+            break;
+        }
+    }
+    history.push_back(frame);
+    while(static_cast<int>(history.size()) > historySize)
+        history.pop_front();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QMovie>
+#include <memory>
+#include "animationdecoderrunnable.h"
+
+// Decodes animation frames on a worker thread.
+//
+// The worker stays a few frames ahead of playback (bounded by memory).
+// Recently shown frames and every Nth decoded frame (keyframes) are kept
+// around, so stepping back or seeking to them does not need decoding.
+// Other backward seeks restart decoding from the first frame in background,
+// as Qt's format plugins can't resume from a saved state.
+//
+// The movie is only used as a source of the opened file and its metadata;
+// it must not be played while the decoder exists.
+class AnimationDecoder : public QObject {
+    Q_OBJECT
+public:
+    explicit AnimationDecoder(std::shared_ptr<QMovie> _movie, QObject *parent = nullptr);
+    ~AnimationDecoder();
+    // 0 if not known yet
+    int frameCount();
+    // Returns the frame right away if it is decoded.
+    // Otherwise redirects the worker to it; frameReady() follows.
+    bool takeFrame(int number, AnimationFrame &frame);
+    // Frames get a copy scaled to this size (AnimationFrame::scaled),
+    // so that the view doesn't have to transform them on every paint.
+    // Invalid size turns it off.
+    void setTargetSize(QSize size, ScalingFilter filter);
+
+signals:
+    void frameReady(int number);
+    void decodingFailed();
+
+private:
+    std::shared_ptr<QMovie> movie;
+    AnimationDecoderState state;
+    QThreadPool *pool;
+    AnimationDecoderRunnable *runnable;
+    std::deque<AnimationFrame> history; // recently shown
+    int historySize;
+
+    void addToHistory(const AnimationFrame &frame);
+};
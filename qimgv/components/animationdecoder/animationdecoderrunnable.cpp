@@ -0,0 +1,164 @@
+#include "animationdecoderrunnable.h"
+#include <algorithm>
+
+AnimationDecoderRunnable::AnimationDecoderRunnable(AnimationDecoderState *_state)
+    : state(_state),
+      readerPos(0),
+      readError(false)
+{
+}
+
+void AnimationDecoderRunnable::run() {
+    restartReader();
+    AnimationFrame frame;
+    while(true) {
+        int target;
+        {
+            QMutexLocker lock(&state->mutex);
+            while(!state->stop && static_cast<int>(state->ahead.size()) >= state->aheadLimit
+                  && !std::any_of(state->ahead.begin(), state->ahead.end(),
+                                  [this](const AnimationFrame &f) { return state->needsScaling(f); }))
+            {
+                state->wake.wait(&state->mutex);
+            }
+            if(state->stop)
+                return;
+            target = state->nextToDecode();
+        }
+        // display size changed; fix the queue before decoding more
+        if(rescaleQueued())
+            continue;
+        readError = false;
+        bool ok = (target == readerPos) || seekReader(target);
+        if(ok)
+            ok = readFrame(frame);
+        if(ok) {
+            QSize size;
+            ScalingFilter filter;
+            {
+                QMutexLocker lock(&state->mutex);
+                size = state->targetSize;
+                filter = state->filter;
+            }
+            frame.setScaled(scaleImage(frame.image, size, filter), size);
+        }
+        QMutexLocker lock(&state->mutex);
+        if(state->stop)
+            return;
+        if(!ok && !readError)
+            continue; // seek was cancelled by a new request
+        if(!ok) {
+            if(readerPos == 0) {
+                state->failed = true;
+                emit failed();
+                return;
+            }
+            // ran past the last frame (or a broken one); now we know the count
+            state->frameCount = readerPos;
+            if(state->pending >= readerPos) {
+                state->failed = true;
+                emit failed();
+                return;
+            }
+            continue;
+        }
+        // the gui may have jumped elsewhere while we were decoding
+        if(frame.number != state->nextToDecode())
+            continue;
+        // resized meanwhile; the frame is still usable unscaled
+        if(state->needsScaling(frame))
+            frame.setScaled(QImage(), QSize());
+        state->ahead.push_back(frame);
+        if(state->pending == frame.number) {
+            state->pending = -1;
+            emit frameReady(frame.number);
+        }
+    }
+}
+
+void AnimationDecoderRunnable::restartReader() {
+    if(state->device)
+        state->device->seek(0);
+    reader.reset(new QImageReader(state->device, state->format));
+    readerPos = 0;
+}
+
+// Gets the reader to the target frame. Uses random access if the format plugin
+// supports it, otherwise decodes forward, from the start if needed.
+// Returns false on error or if the request changed meanwhile.
+bool AnimationDecoderRunnable::seekReader(int target) {
+    if(reader->jumpToImage(target)) {
+        readerPos = target;
+        return true;
+    }
+    if(target < readerPos)
+        restartReader();
+    AnimationFrame skipped;
+    while(readerPos < target) {
+        {
+            QMutexLocker lock(&state->mutex);
+            if(state->stop || state->nextToDecode() != target)
+                return false;
+        }
+        if(!readFrame(skipped))
+            return false;
+    }
+    return true;
+}
+
+bool AnimationDecoderRunnable::readFrame(AnimationFrame &frame) {
+    QImage image;
+    if(!reader->read(&image)) {
+        readError = true;
+        return false;
+    }
+    frame.number = readerPos++;
+    frame.delay = qMax(reader->nextImageDelay(), 0);
+    // do the conversion QPixmap::fromImage() would otherwise do on the gui thread
+    if(image.hasAlphaChannel())
+        frame.setImage(image.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    else
+        frame.setImage(image.convertToFormat(QImage::Format_RGB32));
+    if(frame.number % state->keyframeInterval == 0) {
+        QMutexLocker lock(&state->mutex);
+        if(state->keyframes.contains(frame.number) || state->keyframes.count() < state->keyframeLimit)
+            state->keyframes.insert(frame.number, frame);
+    }
+    return true;
+}
+
+// Rescales one queued frame whose scaled copy doesn't match the target size.
+// Returns false if there was nothing to do.
+bool AnimationDecoderRunnable::rescaleQueued() {
+    AnimationFrame frame;
+    QSize size;
+    ScalingFilter filter;
+    {
+        QMutexLocker lock(&state->mutex);
+        auto it = std::find_if(state->ahead.begin(), state->ahead.end(),
+                               [this](const AnimationFrame &f) { return state->needsScaling(f); });
+        if(it == state->ahead.end())
+            return false;
+        frame = *it;
+        size = state->targetSize;
+        filter = state->filter;
+    }
+    QImage scaled = scaleImage(frame.image, size, filter);
+    QMutexLocker lock(&state->mutex);
+    if(size != state->targetSize || filter != state->filter)
+        return true;
+    for(auto &f : state->ahead) {
+        if(f.number == frame.number) {
+            f.setScaled(scaled, size);
+            break;
+        }
+    }
+    return true;
+}
+
+QImage AnimationDecoderRunnable::scaleImage(const QImage &image, QSize size, ScalingFilter filter) {
+    if(!size.isValid() || size.isEmpty() || size == image.size())
+        return QImage();
+    std::unique_ptr<QImage> scaled(ImageLib::scaled(std::make_shared<const QImage>(image), size, filter));
+    return scaled ? *scaled : QImage();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QImageReader>
+#include <QImage>
+#include <QMap>
+#include <QDebug>
+#include <deque>
+#include <memory>
+#include "utils/imagelib.h"
+#include "components/metrics/memorymetrics.h"
+
+// Copies share the pixel data and the charges for it (MEM_ANIMATION_FRAMES).
+struct AnimationFrame {
+    int number = -1;
+    QImage image;
+    QImage scaled; // image at targetSize, if one is set
+    QSize scaledFor; // targetSize scaled was made for; null scaled if scaling failed
+    int delay = 0;
+    std::shared_ptr<MemoryCharge> imageCharge, scaledCharge;
+
+    void setImage(const QImage &_image) {
+        image = _image;
+        imageCharge = std::make_shared<MemoryCharge>(MEM_ANIMATION_FRAMES, MemoryMetrics::bytesOf(image));
+    }
+    void setScaled(const QImage &_scaled, QSize targetSize) {
+        scaled = _scaled;
+        scaledFor = targetSize;
+        scaledCharge = std::make_shared<MemoryCharge>(MEM_ANIMATION_FRAMES, MemoryMetrics::bytesOf(scaled));
+    }
+};
+
+// Shared between AnimationDecoder (gui thread) and the worker.
+// Everything below the mutex is guarded by it.
+struct AnimationDecoderState {
+    QIODevice *device = nullptr;
+    QByteArray format;
+    int keyframeInterval = 1;
+    int keyframeLimit = 0;
+
+    QMutex mutex;
+    QWaitCondition wake;
+    bool stop = false;
+    bool failed = false;
+    int frameCount = 0;        // 0 until known
+    int next = 0;              // first frame the worker should produce
+    int pending = -1;          // frame the gui is waiting for
+    int aheadLimit = 2;
+    QSize targetSize;          // invalid: display at full size
+    ScalingFilter filter = QI_FILTER_BILINEAR;
+    std::deque<AnimationFrame> ahead; // decoded, consecutive (wrapping), starting at next
+    QMap<int, AnimationFrame> keyframes;
+
+    // next frame to go into the queue; call with the mutex held
+    int nextToDecode() const {
+        int number = ahead.empty() ? next : ahead.back().number + 1;
+        return (frameCount && number >= frameCount) ? 0 : number;
+    }
+
+    // scaled copy is missing or made for another size; call with the mutex held
+    // a failed attempt counts as done until the size changes
+    bool needsScaling(const AnimationFrame &frame) const {
+        if(!targetSize.isValid() || targetSize.isEmpty() || targetSize == frame.image.size())
+            return !frame.scaled.isNull();
+        return frame.scaledFor != targetSize;
+    }
+};
+
+class AnimationDecoderRunnable : public QObject, public QRunnable {
+    Q_OBJECT
+public:
+    AnimationDecoderRunnable(AnimationDecoderState *_state);
+    void run();
+
+signals:
+    void frameReady(int number);
+    void failed();
+
+private:
+    AnimationDecoderState *state;
+    std::unique_ptr<QImageReader> reader;
+    int readerPos;
+    bool readError;
+
+    void restartReader();
+    bool seekReader(int target);
+    bool readFrame(AnimationFrame &frame);
+    bool rescaleQueued();
+    static QImage scaleImage(const QImage &image, QSize size, ScalingFilter filter);
+};
@@ -0,0 +1,131 @@
+#include "bufferpool.h"
+#include "settings.h"
+#include "components/metrics/memorymetrics.h"
+#include <cstdlib>
+#include <climits>
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+// images below this are not worth pooling
+#define POOL_MIN_SIZE    (4 * 1024 * 1024)
+#define POOL_MAX_IDLE    4
+// transparent huge pages need this alignment
+#define BUFFER_ALIGNMENT (2 * 1024 * 1024)
+
+QMutex BufferPool::mutex;
+std::list<BufferPool::Buffer*> BufferPool::idle;
+size_t BufferPool::idleBytes = 0;
+
+QImage BufferPool::createImage(QSize size, QImage::Format format) {
+    if(size.isEmpty() || format == QImage::Format_Invalid)
+        return QImage();
+    int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    // same limit QImageReader applies; it is skipped for images handed to it
+    if(settings && qint64(size.width()) * size.height() * depth / 8 > qint64(settings->snapshot()->memoryAllocationLimit) * 1024 * 1024) {
+        qDebug() << "[BufferPool] image exceeds memoryAllocationLimit:" << size;
+        return QImage();
+    }
+    // same row alignment QImage uses
+    qint64 bpl = ((qint64(size.width()) * depth + 31) >> 5) << 2;
+    qint64 bytes = bpl * size.height();
+    if(bytes < POOL_MIN_SIZE || bpl > INT_MAX)
+        return QImage(size, format);
+    Buffer *buffer = acquire(static_cast<size_t>(bytes));
+    if(!buffer)
+        return QImage();
+    return QImage(buffer->data, size.width(), size.height(), static_cast<int>(bpl), format, &BufferPool::release, buffer);
+}
+
+void BufferPool::trim() {
+    QMutexLocker lock(&mutex);
+    for(auto buffer : idle)
+        deallocate(buffer);
+    idle.clear();
+    MemoryMetrics::add(MEM_BUFFER_POOL, -static_cast<qint64>(idleBytes));
+    idleBytes = 0;
+}
+
+// Rounds up to a multiple of step, 1/8 of the largest power of two <= bytes.
+// That is 8 classes between 2^n and 2^(n+1), so a buffer is at most 12.5% bigger
+// than requested, and sizes differing by a few rows share a class.
+size_t BufferPool::sizeClass(size_t bytes) {
+    size_t step = 1;
+    while((step << 3) <= bytes)
+        step <<= 1;
+    step >>= 1;
+    return (bytes + step - 1) / step * step;
+}
+
+BufferPool::Buffer *BufferPool::acquire(size_t bytes) {
+    size_t size = sizeClass(bytes);
+    {
+        QMutexLocker lock(&mutex);
+        for(auto it = idle.begin(); it != idle.end(); ++it) {
+            if((*it)->size == size) {
+                Buffer *buffer = *it;
+                idle.erase(it);
+                idleBytes -= buffer->size;
+                MemoryMetrics::add(MEM_BUFFER_POOL, -static_cast<qint64>(buffer->size));
+                return buffer;
+            }
+        }
+    }
+    uchar *data = allocate(size);
+    if(!data) {
+        // maybe idle buffers were in the way
+        trim();
+        data = allocate(size);
+        if(!data) {
+            qDebug() << "[BufferPool] could not allocate" << size << "bytes";
+            return nullptr;
+        }
+    }
+    return new Buffer { data, size };
+}
+
+// called from whichever thread destroys the image
+void BufferPool::release(void *info) {
+    auto buffer = static_cast<Buffer*>(info);
+    size_t limit = 0; // settings are gone at exit
+    if(settings) {
+        limit = static_cast<size_t>(settings->snapshot()->memoryAllocationLimit) * 1024 * 1024;
+        // idle buffers only get what the caches leave free
+        qint64 budget = MemoryMetrics::cacheBudgetLeft() + MemoryMetrics::bytes(MEM_BUFFER_POOL);
+        limit = qMin(limit, static_cast<size_t>(qMax<qint64>(budget, 0)));
+    }
+    QMutexLocker lock(&mutex);
+    if(buffer->size > limit) {
+        deallocate(buffer);
+        return;
+    }
+    idle.push_front(buffer);
+    idleBytes += buffer->size;
+    MemoryMetrics::add(MEM_BUFFER_POOL, static_cast<qint64>(buffer->size));
+    while(idleBytes > limit || idle.size() > POOL_MAX_IDLE) {
+        idleBytes -= idle.back()->size;
+        MemoryMetrics::add(MEM_BUFFER_POOL, -static_cast<qint64>(idle.back()->size));
+        deallocate(idle.back());
+        idle.pop_back();
+    }
+}
+
+uchar *BufferPool::allocate(size_t bytes) {
+    void *data = nullptr;
+#ifdef Q_OS_UNIX
+    if(posix_memalign(&data, BUFFER_ALIGNMENT, bytes))
+        return nullptr;
+#ifdef MADV_HUGEPAGE
+    // fewer page faults & tlb misses on first touch; only a hint
+    madvise(data, bytes, MADV_HUGEPAGE);
+#endif
+#else
+    data = malloc(bytes);
+#endif
+    return static_cast<uchar*>(data);
+}
+
+void BufferPool::deallocate(Buffer *buffer) {
+    free(buffer->data);
+    delete buffer;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QDebug>
+#include <list>
+
+// Reusable pixel buffers for large decoded images.
+//
+// Paging through same-size photos allocates and frees a buffer of the same
+// size each time, paying for mmap and page faults on every load.
+// Images created here are backed by pooled memory which goes back to the pool
+// when the last QImage copy is destroyed, and is handed to the next image of
+// the same size class.
+//
+// Idle memory is bounded by the memoryAllocationLimit setting
+// and by the cache budget (MemoryMetrics), counted as MEM_BUFFER_POOL.
+class BufferPool {
+public:
+    // Returns a null image on allocation failure
+    // or if the image exceeds memoryAllocationLimit.
+    // Small images are allocated normally.
+    static QImage createImage(QSize size, QImage::Format format);
+    // free all idle buffers
+    static void trim();
+
+private:
+    struct Buffer {
+        uchar *data;
+        size_t size;
+    };
+
+    static size_t sizeClass(size_t bytes);
+    static Buffer *acquire(size_t bytes);
+    static void release(void *info);
+    static uchar *allocate(size_t bytes);
+    static void deallocate(Buffer *buffer);
+
+    static QMutex mutex;
+    static std::list<Buffer*> idle; // most recently released first
+    static size_t idleBytes;
+};
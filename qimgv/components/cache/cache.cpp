@@ -3,74 +3,84 @@
 Cache::Cache() {
 }
 
+Cache::Shard &Cache::shardFor(const QString &path) {
+    return shards[qHash(path) % CACHE_SHARDS];
+}
+
+const Cache::Shard &Cache::shardFor(const QString &path) const {
+    return shards[qHash(path) % CACHE_SHARDS];
+}
+
 bool Cache::contains(QString path) const {
-    return items.contains(path);
+    auto &shard = shardFor(path);
+    QMutexLocker lock(&shard.mutex);
+    return shard.items.contains(path);
 }
 
 bool Cache::insert(std::shared_ptr<Image> img) {
-    if(img) {
-        if(items.contains(img->filePath())) {
-            return false;
-        } else {
-            items.insert(img->filePath(), new CacheItem(img));
-            return true;
-        }
-    }
-    // TODO: what state returns here ??
+    if(!img)
+        return true;
+    QString path = img->filePath();
+    auto &shard = shardFor(path);
+    QMutexLocker lock(&shard.mutex);
+    if(shard.items.contains(path))
+        return false;
+    shard.items.insert(path, { img, std::make_shared<MemoryCharge>(MEM_IMAGE_CACHE, img->memoryBytes()) });
     return true;
 }
 
+// Removed images are released after unlocking (declared before the locker);
+// freeing a large one takes a while.
 void Cache::remove(QString path) {
-    if(items.contains(path)) {
-        items[path]->lock();
-        auto *item = items.take(path);
-        delete item;
-    }
+    Item item;
+    auto &shard = shardFor(path);
+    QMutexLocker lock(&shard.mutex);
+    item = shard.items.take(path);
 }
 
 void Cache::clear() {
-    for(auto path : items.keys()) {
-        items[path]->lock();
-        auto item = items.take(path);
-        delete item;
+    for(auto &shard : shards) {
+        QHash<QString, Item> items;
+        QMutexLocker lock(&shard.mutex);
+        items.swap(shard.items);
     }
 }
 
-std::shared_ptr<Image> Cache::get(QString path) {
-    if(items.contains(path)) {
-        CacheItem *item = items.value(path);
-        return item->getContents();
-    }
-    return nullptr;
-}
-
-bool Cache::reserve(QString path) {
-    if(items.contains(path)) {
-        items[path]->lock();
-        return true;
-    }
-    return false;
+void Cache::refresh(QString path) {
+    auto &shard = shardFor(path);
+    QMutexLocker lock(&shard.mutex);
+    auto it = shard.items.find(path);
+    if(it != shard.items.end())
+        it->charge->set(it->image->memoryBytes());
 }
 
-bool Cache::release(QString path) {
-    if(items.contains(path)) {
-        items[path]->unlock();
-        return true;
-    }
-    return false;
+std::shared_ptr<Image> Cache::get(QString path) const {
+    auto &shard = shardFor(path);
+    QMutexLocker lock(&shard.mutex);
+    return shard.items.value(path).image;
 }
 
 // removes all items except the ones in list
 void Cache::trimTo(QStringList pathList) {
-    for(auto path : items.keys()) {
-        if(!pathList.contains(path)) {
-            items[path]->lock();
-            auto *item = items.take(path);
-            delete item;
+    for(auto &shard : shards) {
+        QList<Item> removed;
+        QMutexLocker lock(&shard.mutex);
+        for(auto it = shard.items.begin(); it != shard.items.end();) {
+            if(!pathList.contains(it.key())) {
+                removed.append(it.value());
+                it = shard.items.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
 }
 
 const QList<QString> Cache::keys() const {
-    return items.keys();
+    QList<QString> list;
+    for(auto &shard : shards) {
+        QMutexLocker lock(&shard.mutex);
+        list.append(shard.items.keys());
+    }
+    return list;
 }
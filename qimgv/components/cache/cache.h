@@ -1,13 +1,24 @@
 #pragma once
 
 #include <QDebug>
-#include <QMap>
-#include <QSemaphore>
+#include <QHash>
+#include <QMutex>
 #include <QMutexLocker>
 #include "sourcecontainers/image.h"
-#include "components/cache/cacheitem.h"
 #include "utils/imagefactory.h"
+#include "components/metrics/memorymetrics.h"
 
+#define CACHE_SHARDS 8
+
+// Decoded images by file path. Safe to use from any thread.
+//
+// Lifetimes are managed by shared_ptr: anyone still using an image
+// (scaler, viewer) holds a reference, so removing it from the cache
+// never waits for them. Entries are spread over several independently
+// locked shards, so workers touching one path do not contend with the
+// gui thread touching another.
+//
+// Cached images are counted as MEM_IMAGE_CACHE.
 class Cache {
 public:
     explicit Cache();
@@ -15,14 +26,25 @@ public:
     void remove(QString path);
     void clear();
 
+    // false if the path is already cached
     bool insert(std::shared_ptr<Image> img);
     void trimTo(QStringList list);
+    // re-count the image after it was edited
+    void refresh(QString path);
 
-    std::shared_ptr<Image> get(QString path);
-    bool release(QString path);
-    bool reserve(QString path);
+    std::shared_ptr<Image> get(QString path) const;
     const QList<QString> keys() const;
 
 private:
-    QMap<QString, CacheItem*> items;
+    struct Item {
+        std::shared_ptr<Image> image;
+        std::shared_ptr<MemoryCharge> charge;
+    };
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<QString, Item> items;
+    };
+    Shard shards[CACHE_SHARDS];
+    Shard &shardFor(const QString &path);
+    const Shard &shardFor(const QString &path) const;
 };
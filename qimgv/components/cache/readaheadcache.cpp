@@ -0,0 +1,108 @@
+#include "readaheadcache.h"
+
+// total size of file contents kept in memory
+#define READAHEAD_BUDGET        (512 * 1024 * 1024)
+// videos & such are not worth it
+#define READAHEAD_MAX_FILE_SIZE (64 * 1024 * 1024)
+
+ReadAheadCache::ReadAheadCache(QObject *parent)
+    : QObject(parent),
+      discardReading(false),
+      bytes(0),
+      charge(MEM_READAHEAD)
+{
+    pool = new QThreadPool(this);
+    pool->setMaxThreadCount(1);
+}
+
+ReadAheadCache::~ReadAheadCache() {
+    clear();
+    pool->waitForDone();
+}
+
+void ReadAheadCache::setWindow(const QStringList &paths) {
+    window = paths;
+    for(auto it = entries.begin(); it != entries.end();) {
+        if(!window.contains(it.key())) {
+            bytes -= it.value().data.size();
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    charge.set(bytes);
+    queue.clear();
+    for(auto const &path : window) {
+        if(!entries.contains(path) && path != readingPath)
+            queue.append(path);
+    }
+    startNext();
+}
+
+FileContents ReadAheadCache::take(const QString &path) {
+    FileContents contents = entries.take(path);
+    bytes -= contents.data.size();
+    charge.set(bytes);
+    return contents;
+}
+
+void ReadAheadCache::putBack(const QString &path, FileContents contents) {
+    if(contents.isEmpty() || !window.contains(path) || entries.contains(path))
+        return;
+    entries.insert(path, contents);
+    bytes += contents.data.size();
+    charge.set(bytes);
+}
+
+void ReadAheadCache::remove(const QString &path) {
+    take(path);
+    if(path == readingPath)
+        discardReading = true;
+    queue.removeAll(path);
+    window.removeAll(path);
+}
+
+void ReadAheadCache::clear() {
+    window.clear();
+    queue.clear();
+    entries.clear();
+    bytes = 0;
+    charge.set(0);
+}
+
+qint64 ReadAheadCache::totalBytes() const {
+    return bytes;
+}
+
+void ReadAheadCache::startNext() {
+    if(!readingPath.isEmpty() || queue.isEmpty())
+        return;
+    qint64 maxSize = qMin<qint64>(READAHEAD_BUDGET - bytes, READAHEAD_MAX_FILE_SIZE);
+    maxSize = qMin(maxSize, MemoryMetrics::cacheBudgetLeft());
+    if(maxSize <= 0)
+        return;
+    readingPath = queue.takeFirst();
+    auto runnable = new ReadAheadRunnable(readingPath, maxSize);
+    connect(runnable, &ReadAheadRunnable::finished, this, &ReadAheadCache::onReadFinished);
+    pool->start(runnable);
+}
+
+void ReadAheadCache::onReadFinished(QString path, QByteArray data, QDateTime lastModified, qint64 fileSize) {
+    readingPath.clear();
+    if(discardReading) {
+        discardReading = false;
+        data.clear();
+        fileSize = -1;
+    }
+    // window could have moved on while reading
+    if(!data.isEmpty() && window.contains(path)) {
+        entries.insert(path, { data, lastModified });
+        bytes += data.size();
+        charge.set(bytes);
+    } else if(data.isEmpty() && fileSize > 0 && fileSize <= READAHEAD_MAX_FILE_SIZE) {
+        // out of budget; further files can wait until the window moves
+        queue.clear();
+        return;
+    }
+    startNext();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QHash>
+#include <QStringList>
+#include <QByteArray>
+#include "readaheadrunnable.h"
+#include "sourcecontainers/filecontents.h"
+#include "components/metrics/memorymetrics.h"
+#include <QDebug>
+
+// Second cache tier holding undecoded file contents.
+//
+// A decoded 40MP image costs ~160MB while the file is a few tens of MB,
+// so files further ahead than the decoded cache reaches are kept as raw bytes.
+// They are read in the background, one file at a time, nearest first,
+// until the byte budget runs out. Decoding from memory then skips the
+// i/o wait, which matters on slow or network storage.
+// Only memory left free by the other caches is used (MemoryMetrics).
+class ReadAheadCache : public QObject {
+    Q_OBJECT
+public:
+    explicit ReadAheadCache(QObject *parent = nullptr);
+    ~ReadAheadCache();
+    // Files to keep in memory, nearest first.
+    // Entries outside of the window are dropped.
+    void setWindow(const QStringList &paths);
+    // Returns and forgets the file contents.
+    // Empty if the file was not read (yet).
+    FileContents take(const QString &path);
+    // Gives back contents from take() which were not used.
+    // Kept if the file is still in the window.
+    void putBack(const QString &path, FileContents contents);
+    void remove(const QString &path);
+    void clear();
+    qint64 totalBytes() const;
+
+private:
+    QThreadPool *pool;
+    QStringList window;
+    QStringList queue;
+    QHash<QString, FileContents> entries;
+    QString readingPath;
+    // readingPath was removed while being read
+    bool discardReading;
+    qint64 bytes;
+    MemoryCharge charge;
+    void startNext();
+
+private slots:
+    void onReadFinished(QString path, QByteArray data, QDateTime lastModified, qint64 fileSize);
+};
@@ -0,0 +1,19 @@
+#include "readaheadrunnable.h"
+
+ReadAheadRunnable::ReadAheadRunnable(QString _path, qint64 _maxSize) : path(_path), maxSize(_maxSize) {
+}
+
+void ReadAheadRunnable::run() {
+    // before reading, so a write in the meantime shows as a newer file
+    QDateTime lastModified = QFileInfo(path).lastModified();
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) {
+        emit finished(path, QByteArray(), lastModified, -1);
+        return;
+    }
+    qint64 fileSize = file.size();
+    QByteArray data;
+    if(fileSize <= maxSize)
+        data = file.readAll();
+    emit finished(path, data, lastModified, fileSize);
+}
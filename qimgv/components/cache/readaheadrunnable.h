@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+class ReadAheadRunnable : public QObject, public QRunnable {
+    Q_OBJECT
+public:
+    ReadAheadRunnable(QString _path, qint64 _maxSize);
+    void run();
+private:
+    QString path;
+    qint64 maxSize;
+signals:
+    // data is empty if the file is larger than maxSize; fileSize is -1 on error
+    void finished(QString path, QByteArray data, QDateTime lastModified, qint64 fileSize);
+};
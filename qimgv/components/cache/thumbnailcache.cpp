@@ -25,6 +25,7 @@ QImage *ThumbnailCache::readThumbnail(QString id) {
     QString filePath = thumbnailPath(id);
     QFileInfo file(filePath);
     if(file.exists() && file.isReadable()) {
+        MemoryCharge reading(MEM_THUMBNAIL_READS, file.size());
         QImage *thumb = new QImage();
         if(thumb->load(filePath)) {
             return thumb;
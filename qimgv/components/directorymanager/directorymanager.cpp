@@ -1,15 +1,21 @@
 #include "directorymanager.h"
+#include "utils/tracer.h"
 
 namespace fs = std::filesystem;
 
+// Batches with this many changes or more are merged into the lists at once,
+// followed by a single bulkChanged() signal instead of per-entry ones.
+#define BULK_UPDATE_THRESHOLD 64
+
 DirectoryManager::DirectoryManager() :
     watcher(nullptr),
+    rescanTask(nullptr),
     mSortingMode(SORT_NAME)
 {
-    regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
     collator.setNumericMode(true);
 
     readSettings();
+    fileEntryList.setCompare(std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
     setSortingMode(settings->sortingMode());
     connect(settings, &Settings::settingsChanged, this, &DirectoryManager::readSettings);
 }
@@ -20,36 +26,50 @@ insert_sorted(std::vector<T> & vec, T const& item, Pred pred) {
     return vec.insert(std::upper_bound(vec.begin(), vec.end(), item, pred), item);
 }
 
+// All of these fall back to the path on ties so that no two entries compare equal.
+// SortedEntryList relies on that to find entries.
 bool DirectoryManager::path_entry_compare(const FSEntry &e1, const FSEntry &e2) const {
-    return collator.compare(e1.path, e2.path) < 0;
+    int result = collator.compare(e1.path, e2.path);
+    return result ? result < 0 : e1.path < e2.path;
 };
 
 bool DirectoryManager::path_entry_compare_reverse(const FSEntry &e1, const FSEntry &e2) const {
-    return collator.compare(e1.path, e2.path) > 0;
+    int result = collator.compare(e1.path, e2.path);
+    return result ? result > 0 : e1.path > e2.path;
 };
 
 bool DirectoryManager::name_entry_compare(const FSEntry &e1, const FSEntry &e2) const {
-    return collator.compare(e1.name, e2.name) < 0;
+    int result = collator.compare(e1.name, e2.name);
+    return result ? result < 0 : path_entry_compare(e1, e2);
 };
 
 bool DirectoryManager::name_entry_compare_reverse(const FSEntry &e1, const FSEntry &e2) const {
-    return collator.compare(e1.name, e2.name) > 0;
+    int result = collator.compare(e1.name, e2.name);
+    return result ? result > 0 : path_entry_compare_reverse(e1, e2);
 };
 
 bool DirectoryManager::date_entry_compare(const FSEntry& e1, const FSEntry& e2) const {
-    return e1.modifyTime < e2.modifyTime;
+    if(e1.modifyTime != e2.modifyTime)
+        return e1.modifyTime < e2.modifyTime;
+    return path_entry_compare(e1, e2);
 }
 
 bool DirectoryManager::date_entry_compare_reverse(const FSEntry& e1, const FSEntry& e2) const {
-    return e1.modifyTime > e2.modifyTime;
+    if(e1.modifyTime != e2.modifyTime)
+        return e1.modifyTime > e2.modifyTime;
+    return path_entry_compare(e1, e2);
 }
 
 bool DirectoryManager::size_entry_compare(const FSEntry& e1, const FSEntry& e2) const {
-    return e1.size < e2.size;
+    if(e1.size != e2.size)
+        return e1.size < e2.size;
+    return path_entry_compare(e1, e2);
 }
 
 bool DirectoryManager::size_entry_compare_reverse(const FSEntry& e1, const FSEntry& e2) const {
-    return e1.size > e2.size;
+    if(e1.size != e2.size)
+        return e1.size > e2.size;
+    return path_entry_compare(e1, e2);
 }
 
 CompareFunction DirectoryManager::compareFunction() {
@@ -67,17 +87,16 @@ CompareFunction DirectoryManager::compareFunction() {
     return cmpFn;
 }
 
-void DirectoryManager::startFileWatcher(QString directoryPath) {
+void DirectoryManager::startFileWatcher(QString directoryPath, bool recursive) {
     if(directoryPath == "")
         return;
     if(!watcher)
         watcher = DirectoryWatcher::newInstance();
 
-    connect(watcher, &DirectoryWatcher::fileCreated,  this, &DirectoryManager::onFileAddedExternal,    Qt::UniqueConnection);
-    connect(watcher, &DirectoryWatcher::fileDeleted,  this, &DirectoryManager::onFileRemovedExternal,  Qt::UniqueConnection);
-    connect(watcher, &DirectoryWatcher::fileModified, this, &DirectoryManager::onFileModifiedExternal, Qt::UniqueConnection);
-    connect(watcher, &DirectoryWatcher::fileRenamed,  this, &DirectoryManager::onFileRenamedExternal,  Qt::UniqueConnection);
+    connect(watcher, &DirectoryWatcher::changesReady, this, &DirectoryManager::onWatcherChanges, Qt::UniqueConnection);
+    connect(watcher, &DirectoryWatcher::rescanRequired, this, &DirectoryManager::onWatcherRescanRequired, Qt::UniqueConnection);
 
+    watcher->setRecursive(recursive);
     watcher->setWatchPath(directoryPath);
     watcher->observe();
 }
@@ -88,10 +107,8 @@ void DirectoryManager::stopFileWatcher() {
 
     watcher->stopObserving();
 
-    disconnect(watcher, &DirectoryWatcher::fileCreated,  this, &DirectoryManager::onFileAddedExternal);
-    disconnect(watcher, &DirectoryWatcher::fileDeleted,  this, &DirectoryManager::onFileRemovedExternal);
-    disconnect(watcher, &DirectoryWatcher::fileModified, this, &DirectoryManager::onFileModifiedExternal);
-    disconnect(watcher, &DirectoryWatcher::fileRenamed,  this, &DirectoryManager::onFileRenamedExternal);
+    disconnect(watcher, &DirectoryWatcher::changesReady, this, &DirectoryManager::onWatcherChanges);
+    disconnect(watcher, &DirectoryWatcher::rescanRequired, this, &DirectoryManager::onWatcherRescanRequired);
 }
 
 // ##############################################################
@@ -99,7 +116,7 @@ void DirectoryManager::stopFileWatcher() {
 // ##############################################################
 
 void DirectoryManager::readSettings() {
-    regex.setPattern(settings->supportedFormatsRegex());
+    filter.setFormats(settings->snapshot()->supportedFormats);
 }
 
 bool DirectoryManager::setDirectory(QString dirPath) {
@@ -122,10 +139,24 @@ bool DirectoryManager::setDirectory(QString dirPath) {
     mListSource = SOURCE_DIRECTORY;
     mDirectoryPath = dirPath;
 
-    loadEntryList(dirPath, false);
-    sortEntryLists();
-    emit loaded(dirPath);
-    startFileWatcher(dirPath);
+    bool isSorted = false;
+    std::vector<FSEntry> files;
+    if(snapshot.read(dirPath, sortKey(), files, dirEntryVec, isSorted)) {
+        // serve the saved listing right away, then verify it in background
+        fileEntryList.assign(std::move(files), isSorted);
+        if(!isSorted)
+            sortDirEntries();
+        emit loaded(dirPath);
+        startFileWatcher(dirPath, false);
+        startRescan(dirPath, false);
+    } else {
+        cancelRescan();
+        loadEntryList(dirPath, false);
+        emit loaded(dirPath);
+        startFileWatcher(dirPath, false);
+        snapshot.write(dirPath, sortKey(), fileEntryList, dirEntryVec);
+    }
+    updateDirEntryCharge();
     return true;
 }
 
@@ -141,12 +172,12 @@ bool DirectoryManager::setDirectoryRecursive(QString dirPath) {
         qDebug() << "[DirectoryManager] Error - path is not a directory.";
         return false;
     }
-    stopFileWatcher();
+    cancelRescan();
     mListSource = SOURCE_DIRECTORY_RECURSIVE;
     mDirectoryPath = dirPath;
     loadEntryList(dirPath, true);
-    sortEntryLists();
     emit loaded(dirPath);
+    startFileWatcher(dirPath, true);
     return true;
 }
 
@@ -158,12 +189,7 @@ QString DirectoryManager::directoryPath() const {
 }
 
 int DirectoryManager::indexOfFile(QString filePath) const {
-    auto item = find_if(fileEntryVec.begin(), fileEntryVec.end(), [filePath](const FSEntry& e) {
-        return e.path == filePath;
-    });
-    if(item != fileEntryVec.end())
-        return distance(fileEntryVec.begin(), item);
-    return -1;
+    return fileEntryList.indexOf(filePath);
 }
 
 int DirectoryManager::indexOfDir(QString dirPath) const {
@@ -176,11 +202,11 @@ int DirectoryManager::indexOfDir(QString dirPath) const {
 }
 
 QString DirectoryManager::filePathAt(int index) const {
-    return checkFileRange(index) ? fileEntryVec.at(index).path : "";
+    return checkFileRange(index) ? fileEntryList.at(index).path : "";
 }
 
 QString DirectoryManager::fileNameAt(int index) const {
-    return checkFileRange(index) ? fileEntryVec.at(index).name : "";
+    return checkFileRange(index) ? fileEntryList.at(index).name : "";
 }
 
 QString DirectoryManager::dirPathAt(int index) const {
@@ -193,15 +219,15 @@ QString DirectoryManager::dirNameAt(int index) const {
 
 QString DirectoryManager::firstFile() const {
     QString filePath = "";
-    if(fileEntryVec.size())
-        filePath = fileEntryVec.front().path;
+    if(!fileEntryList.empty())
+        filePath = fileEntryList.front().path;
     return filePath;
 }
 
 QString DirectoryManager::lastFile() const {
     QString filePath = "";
-    if(fileEntryVec.size())
-        filePath = fileEntryVec.back().path;
+    if(!fileEntryList.empty())
+        filePath = fileEntryList.back().path;
     return filePath;
 }
 
@@ -209,15 +235,15 @@ QString DirectoryManager::prevOfFile(QString filePath) const {
     QString prevFilePath = "";
     int currentIndex = indexOfFile(filePath);
     if(currentIndex > 0)
-        prevFilePath = fileEntryVec.at(currentIndex - 1).path;
+        prevFilePath = fileEntryList.at(currentIndex - 1).path;
     return prevFilePath;
 }
 
 QString DirectoryManager::nextOfFile(QString filePath) const {
     QString nextFilePath = "";
     int currentIndex = indexOfFile(filePath);
-    if(currentIndex >= 0 && currentIndex < fileEntryVec.size() - 1)
-        nextFilePath = fileEntryVec.at(currentIndex + 1).path;
+    if(currentIndex >= 0 && currentIndex < fileEntryList.size() - 1)
+        nextFilePath = fileEntryList.at(currentIndex + 1).path;
     return nextFilePath;
 }
 
@@ -238,7 +264,7 @@ QString DirectoryManager::nextOfDir(QString dirPath) const {
 }
 
 bool DirectoryManager::checkFileRange(int index) const {
-    return index >= 0 && index < (int)fileEntryVec.size();
+    return index >= 0 && index < fileEntryList.size();
 }
 
 bool DirectoryManager::checkDirRange(int index) const {
@@ -250,7 +276,7 @@ unsigned long DirectoryManager::totalCount() const {
 }
 
 unsigned long DirectoryManager::fileCount() const {
-    return fileEntryVec.size();
+    return fileEntryList.size();
 }
 
 unsigned long DirectoryManager::dirCount() const {
@@ -259,7 +285,7 @@ unsigned long DirectoryManager::dirCount() const {
 
 const FSEntry &DirectoryManager::fileEntryAt(int index) const {
     if(checkFileRange(index))
-        return fileEntryVec.at(index);
+        return fileEntryList.at(index);
     else
         return defaultEntry;
 }
@@ -274,7 +300,7 @@ QDateTime DirectoryManager::lastModified(QString filePath) const {
 // TODO: what about symlinks?
 inline
 bool DirectoryManager::isSupportedFile(QString path) const {
-    return ( isFile(path) && regex.match(path).hasMatch() );
+    return ( filter.matches(path) && isFile(path) );
 }
 
 bool DirectoryManager::isFile(QString path) const {
@@ -294,11 +320,11 @@ bool DirectoryManager::isDir(QString path) const {
 }
 
 bool DirectoryManager::isEmpty() const {
-    return fileEntryVec.empty();
+    return fileEntryList.empty();
 }
 
 bool DirectoryManager::containsFile(QString filePath) const {
-    return (std::find(fileEntryVec.begin(), fileEntryVec.end(), filePath) != fileEntryVec.end());
+    return fileEntryList.contains(filePath);
 }
 
 bool DirectoryManager::containsDir(QString dirPath) const {
@@ -310,91 +336,278 @@ bool DirectoryManager::containsDir(QString dirPath) const {
 // ##############################################################
 void DirectoryManager::loadEntryList(QString directoryPath, bool recursive) {
     dirEntryVec.clear();
-    fileEntryVec.clear();
+    fileEntryList.clear();
+    std::vector<FSEntry> files;
     if(recursive) { // load files only
-        addEntriesFromDirectoryRecursive(fileEntryVec, directoryPath);
+        DirectoryScanner::scanRecursive(directoryPath, filter, files);
     } else { // load dirs & files
-        addEntriesFromDirectory(fileEntryVec, directoryPath);
+        DirectoryScanner::scan(directoryPath, filter, files, dirEntryVec);
     }
+    fileEntryList.assign(std::move(files), false);
+    sortDirEntries();
+    updateDirEntryCharge();
 }
 
-// both directories & files
-void DirectoryManager::addEntriesFromDirectory(std::vector<FSEntry> &entryVec, QString directoryPath) {
-    QRegularExpressionMatch match;
-    for(const auto & entry : fs::directory_iterator(toStdString(directoryPath))) {
-        QString name = QString::fromStdString(entry.path().filename().generic_string());
-#ifndef Q_OS_WIN32
-        // ignore hidden files
-        if(name.startsWith("."))
-            continue;
-#endif
-        QString path = QString::fromStdString(entry.path().generic_string());
-        match = regex.match(name);
-        if(entry.is_directory()) { // this can still throw std::bad_alloc ..
-            FSEntry newEntry;
-            try {
-                newEntry.name = name;
-                newEntry.path = path;
-                newEntry.isDirectory = true;
-                //newEntry.size = entry.file_size();
-                //newEntry.modifyTime = entry.last_write_time();
-            } catch (const std::filesystem::filesystem_error &err) {
-                qDebug() << "[DirectoryManager]" << err.what();
-                continue;
-            }
-            dirEntryVec.emplace_back(newEntry);
-        } else if (match.hasMatch()) {
-            FSEntry newEntry;
-            try {
-                newEntry.name = name;
-                newEntry.path = path;
-                newEntry.isDirectory = false;
-                newEntry.size = entry.file_size();
-                newEntry.modifyTime = entry.last_write_time();
-            } catch (const std::filesystem::filesystem_error &err) {
-                qDebug() << "[DirectoryManager]" << err.what();
-                continue;
-            }
-            entryVec.emplace_back(newEntry);
+// identifies the entry order stored in a snapshot
+QString DirectoryManager::sortKey() const {
+    return QString::number(mSortingMode) + ";" +
+           QString::number(settings->snapshot()->sortFolders) + ";" +
+           collator.locale().name();
+}
+
+void DirectoryManager::startRescan(QString dirPath, bool recursive) {
+    cancelRescan();
+    rescanTask = new DirectoryScanner(dirPath, filter, recursive);
+    rescanTask->setAutoDelete(false);
+    connect(rescanTask, &DirectoryScanner::finished, this, &DirectoryManager::onRescanFinished, Qt::QueuedConnection);
+    QThreadPool::globalInstance()->start(rescanTask);
+}
+
+// an already running task will delete itself once finished
+void DirectoryManager::cancelRescan() {
+    if(!rescanTask)
+        return;
+    if(QThreadPool::globalInstance()->tryTake(rescanTask))
+        delete rescanTask;
+    rescanTask = nullptr;
+}
+
+// Applies the difference between the served snapshot and actual directory contents.
+// Every path is re-checked on disk as the watcher may have changed it after the scan.
+void DirectoryManager::onRescanFinished() {
+    DirectoryScanner *task = qobject_cast<DirectoryScanner*>(sender());
+    if(!task)
+        return;
+    task->deleteLater();
+    if(task != rescanTask)
+        return;
+    rescanTask = nullptr;
+    if(mListSource == SOURCE_LIST || task->path != mDirectoryPath ||
+       task->recursive != (mListSource == SOURCE_DIRECTORY_RECURSIVE))
+    {
+        return;
+    }
+
+    QHash<QString, const FSEntry*> scannedFiles;
+    QSet<QString> scannedDirs, changedPaths;
+    scannedFiles.reserve(task->fileEntries.size());
+    for(auto const &entry : task->fileEntries)
+        scannedFiles.insert(entry.path, &entry);
+    for(auto const &entry : task->dirEntries)
+        scannedDirs.insert(entry.path);
+
+    QSet<QString> currentFiles, currentDirs;
+    currentFiles.reserve(fileEntryList.size());
+    for(auto const &entry : fileEntryList) {
+        currentFiles.insert(entry.path);
+        auto scanned = scannedFiles.value(entry.path, nullptr);
+        if(!scanned || scanned->size != entry.size || scanned->modifyTime != entry.modifyTime)
+            changedPaths.insert(entry.path);
+    }
+    for(auto const &entry : dirEntryVec) {
+        currentDirs.insert(entry.path);
+        if(!scannedDirs.contains(entry.path))
+            changedPaths.insert(entry.path);
+    }
+    for(auto const &entry : task->fileEntries) {
+        if(!currentFiles.contains(entry.path))
+            changedPaths.insert(entry.path);
+    }
+    for(auto const &entry : task->dirEntries) {
+        if(!currentDirs.contains(entry.path))
+            changedPaths.insert(entry.path);
+    }
+    if(refreshEntries(changedPaths) && mListSource == SOURCE_DIRECTORY)
+        snapshot.write(mDirectoryPath, sortKey(), fileEntryList, dirEntryVec);
+}
+
+// re-reads a single entry from disk, emitting the per-entry signals
+void DirectoryManager::refreshEntry(const QString &path) {
+    if(mListSource == SOURCE_DIRECTORY_RECURSIVE) {
+        if(isSupportedFile(path)) {
+            if(containsFile(path))
+                updateFileEntry(path);
+            else
+                forceInsertFileEntry(path);
+        } else {
+            removeFileEntry(path);
         }
+    } else if(isDir(path)) {
+        removeFileEntry(path);
+        insertDirEntry(path);
+    } else if(isSupportedFile(path)) {
+        removeDirEntry(path);
+        if(containsFile(path))
+            updateFileEntry(path);
+        else
+            forceInsertFileEntry(path);
+    } else {
+        removeFileEntry(path);
+        removeDirEntry(path);
     }
 }
 
-void DirectoryManager::addEntriesFromDirectoryRecursive(std::vector<FSEntry> &entryVec, QString directoryPath) {
-    QRegularExpressionMatch match;
-    for(const auto & entry : fs::recursive_directory_iterator(toStdString(directoryPath))) {
+bool DirectoryManager::refreshEntries(const QSet<QString> &paths) {
+    if(paths.isEmpty())
+        return false;
+    if(paths.count() >= BULK_UPDATE_THRESHOLD)
+        return applyBulkUpdate(paths);
+    for(auto const &path : paths)
+        refreshEntry(path);
+    return true;
+}
+
+// Re-reads all given paths from disk and updates both lists in one go.
+// Files are updated in place at O(log n) each; for dirs stale entries are
+// dropped in a single pass, then the new ones are sorted separately and merged in.
+bool DirectoryManager::applyBulkUpdate(const QSet<QString> &paths, const QHash<QString, QString> &renames) {
+    DirectoryChanges changes;
+    QHash<QString, int> currentDirs;
+    for(int i = 0; i < (int)dirEntryVec.size(); i++) {
+        if(paths.contains(dirEntryVec[i].path))
+            currentDirs.insert(dirEntryVec[i].path, i);
+    }
+    // recursive mode lists files only
+    bool listDirs = (mListSource != SOURCE_DIRECTORY_RECURSIVE);
+    std::vector<bool> dropDirs(dirEntryVec.size(), false);
+    std::vector<FSEntry> newFiles, newDirs;
+    for(auto const &path : paths) {
+        std::error_code ec;
+        fs::directory_entry entry(toStdString(path), ec);
+        bool exists = !ec && entry.exists(ec);
+        bool isDirNow = exists && entry.is_directory(ec);
+        bool isFileNow = exists && !isDirNow && entry.is_regular_file(ec) && filter.matches(path);
+        std::uintmax_t size = 0;
+        fs::file_time_type modifyTime;
+        if(isFileNow) {
+            size = entry.file_size(ec);
+            modifyTime = entry.last_write_time(ec);
+            isFileNow = !ec;
+        }
         QString name = QString::fromStdString(entry.path().filename().generic_string());
-        QString path = QString::fromStdString(entry.path().generic_string());
-        match = regex.match(name);
-        if(!entry.is_directory() && match.hasMatch()) {
-            FSEntry newEntry;
-            try {
-                newEntry.name = name;
-                newEntry.path = path;
-                newEntry.isDirectory = false;
-                newEntry.size = entry.file_size();
-                newEntry.modifyTime = entry.last_write_time();
-            } catch (const std::filesystem::filesystem_error &err) {
-                qDebug() << "[DirectoryManager]" << err.what();
-                continue;
+
+        const FSEntry *oldEntry = fileEntryList.find(path);
+        if(oldEntry) {
+            if(!isFileNow) {
+                changes.removedFiles << path;
+                changes.removedFileIndexes << fileEntryList.indexOf(path);
+            } else if(oldEntry->size != size || oldEntry->modifyTime != modifyTime) {
+                // re-inserted so it ends up in the right place when sorted by date/size
+                newFiles.emplace_back(path, name, size, modifyTime, false);
+                changes.modifiedFiles << path;
+            }
+        } else if(isFileNow) {
+            newFiles.emplace_back(path, name, size, modifyTime, false);
+            changes.addedFiles << path;
+        }
+
+        auto dirIt = currentDirs.constFind(path);
+        if(dirIt != currentDirs.constEnd() && !isDirNow) {
+            dropDirs[dirIt.value()] = true;
+            changes.removedDirs << path;
+        } else if(dirIt == currentDirs.constEnd() && isDirNow && listDirs) {
+            newDirs.emplace_back(path, name, true);
+            changes.addedDirs << path;
+        }
+    }
+    // a removed + added pair the watcher knows to be a rename is reported as one,
+    // so listeners can follow the file
+    if(!renames.isEmpty()) {
+        QSet<QString> removed, added, renamedFrom, renamedTo;
+        for(auto const &path : changes.removedFiles)
+            removed.insert(path);
+        for(auto const &path : changes.addedFiles)
+            added.insert(path);
+        for(auto it = renames.constBegin(); it != renames.constEnd(); ++it) {
+            if(removed.contains(it.key()) && added.contains(it.value()) && !renamedTo.contains(it.value())) {
+                changes.renamedFiles.append(qMakePair(it.key(), it.value()));
+                renamedFrom.insert(it.key());
+                renamedTo.insert(it.value());
+            }
+        }
+        if(!changes.renamedFiles.isEmpty()) {
+            QStringList removedFiles, addedFiles;
+            QVector<int> removedFileIndexes;
+            for(int i = 0; i < changes.removedFiles.count(); i++) {
+                if(!renamedFrom.contains(changes.removedFiles.at(i))) {
+                    removedFiles << changes.removedFiles.at(i);
+                    removedFileIndexes << changes.removedFileIndexes.at(i);
+                }
             }
-            entryVec.emplace_back(newEntry);
+            for(auto const &path : changes.addedFiles) {
+                if(!renamedTo.contains(path))
+                    addedFiles << path;
+            }
+            changes.removedFiles = removedFiles;
+            changes.removedFileIndexes = removedFileIndexes;
+            changes.addedFiles = addedFiles;
         }
     }
+    if(changes.removedFiles.isEmpty() && changes.addedFiles.isEmpty() && changes.modifiedFiles.isEmpty() &&
+       changes.renamedFiles.isEmpty() && changes.removedDirs.isEmpty() && changes.addedDirs.isEmpty())
+    {
+        return false;
+    }
+    emit bulkChangeStarted();
+    // drop
+    auto compact = [](std::vector<FSEntry> &vec, const std::vector<bool> &drop) {
+        size_t pos = 0;
+        for(size_t i = 0; i < vec.size(); i++) {
+            if(drop[i])
+                continue;
+            if(pos != i)
+                vec[pos] = std::move(vec[i]);
+            pos++;
+        }
+        vec.resize(pos);
+    };
+    for(auto const &path : changes.removedFiles)
+        fileEntryList.remove(path);
+    for(auto const &rename : changes.renamedFiles)
+        fileEntryList.remove(rename.first);
+    for(auto const &entry : newFiles)
+        fileEntryList.insert(entry);
+    compact(dirEntryVec, dropDirs);
+    // merge
+    auto merge = [](std::vector<FSEntry> &vec, std::vector<FSEntry> &newEntries, auto cmp) {
+        std::sort(newEntries.begin(), newEntries.end(), cmp);
+        size_t mid = vec.size();
+        vec.insert(vec.end(), std::make_move_iterator(newEntries.begin()), std::make_move_iterator(newEntries.end()));
+        std::inplace_merge(vec.begin(), vec.begin() + mid, vec.end(), cmp);
+    };
+    CompareFunction dirCompareFn = settings->snapshot()->sortFolders ? compareFunction() : &DirectoryManager::path_entry_compare;
+    merge(dirEntryVec, newDirs, std::bind(dirCompareFn, this, std::placeholders::_1, std::placeholders::_2));
+    updateDirEntryCharge();
+
+    emit bulkChanged(changes);
+    return true;
 }
 
 void DirectoryManager::sortEntryLists() {
-    if(settings->sortFolders())
+    sortDirEntries();
+    fileEntryList.sort();
+}
+
+void DirectoryManager::sortDirEntries() {
+    TRACE_SCOPE("DirectoryManager::sortDirEntries", "directory");
+    if(settings->snapshot()->sortFolders)
         std::sort(dirEntryVec.begin(), dirEntryVec.end(), std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
     else
         std::sort(dirEntryVec.begin(), dirEntryVec.end(), std::bind(&DirectoryManager::path_entry_compare, this, std::placeholders::_1, std::placeholders::_2));
-    std::sort(fileEntryVec.begin(), fileEntryVec.end(), std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+}
+
+void DirectoryManager::updateDirEntryCharge() {
+    qint64 bytes = static_cast<qint64>(dirEntryVec.capacity() - dirEntryVec.size()) * sizeof(FSEntry);
+    for(auto const &entry : dirEntryVec)
+        bytes += entry.memoryBytes();
+    dirEntryCharge.set(bytes);
 }
 
 void DirectoryManager::setSortingMode(SortingMode mode) {
     if(mode != mSortingMode) {
         mSortingMode = mode;
-        if(fileEntryVec.size() > 1 || dirEntryVec.size() > 1) {
+        fileEntryList.setCompare(std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+        if(fileEntryList.size() > 1 || dirEntryVec.size() > 1) {
             sortEntryLists();
             emit sortingChanged();
         }
@@ -413,14 +626,14 @@ bool DirectoryManager::insertFileEntry(const QString &filePath) {
     return forceInsertFileEntry(filePath);
 }
 
-// skips filename regex check
+// skips file extension check
 bool DirectoryManager::forceInsertFileEntry(const QString &filePath) {
     if(!this->isFile(filePath) || containsFile(filePath))
         return false;
     std::filesystem::directory_entry stdEntry(toStdString(filePath));
     QString fileName = QString::fromStdString(stdEntry.path().filename().generic_string()); // isn't it beautiful
     FSEntry FSEntry(filePath, fileName, stdEntry.file_size(), stdEntry.last_write_time(), stdEntry.is_directory());
-    insert_sorted(fileEntryVec, FSEntry, std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+    fileEntryList.insert(FSEntry);
     if(!directoryPath().isEmpty()) {
         qDebug() << "fileIns" << filePath << directoryPath();
         emit fileAdded(filePath);
@@ -429,10 +642,9 @@ bool DirectoryManager::forceInsertFileEntry(const QString &filePath) {
 }
 
 void DirectoryManager::removeFileEntry(const QString &filePath) {
-    if(!containsFile(filePath))
+    int index = fileEntryList.remove(filePath);
+    if(index == -1)
         return;
-    int index = indexOfFile(filePath);
-    fileEntryVec.erase(fileEntryVec.begin() + index);
     qDebug() << "fileRem" << filePath;
     emit fileRemoved(filePath, index);
 }
@@ -441,9 +653,14 @@ void DirectoryManager::updateFileEntry(const QString &filePath) {
     if(!containsFile(filePath))
         return;
     FSEntry newEntry(filePath);
-    int index = indexOfFile(filePath);
-    if(fileEntryVec.at(index).modifyTime != newEntry.modifyTime)
-        fileEntryVec.at(index) = newEntry;
+    const FSEntry *oldEntry = fileEntryList.find(filePath);
+    if(oldEntry->modifyTime != newEntry.modifyTime || oldEntry->size != newEntry.size) {
+        // may move when sorted by date/size
+        int oldIndex = fileEntryList.indexOf(filePath);
+        int newIndex = fileEntryList.insert(newEntry);
+        if(newIndex != oldIndex)
+            emit fileMoved(filePath, oldIndex, newIndex);
+    }
     qDebug() << "fileMod" << filePath;
     emit fileModified(filePath);
 }
@@ -463,19 +680,17 @@ void DirectoryManager::renameFileEntry(const QString &oldFilePath, const QString
         return;
     }
     if(containsFile(newFilePath)) {
-        int replaceIndex = indexOfFile(newFilePath);
-        fileEntryVec.erase(fileEntryVec.begin() + replaceIndex);
+        int replaceIndex = fileEntryList.remove(newFilePath);
         emit fileRemoved(newFilePath, replaceIndex);
     }
     // remove the old one
-    int oldIndex = indexOfFile(oldFilePath);
-    fileEntryVec.erase(fileEntryVec.begin() + oldIndex);
+    int oldIndex = fileEntryList.remove(oldFilePath);
     // insert
     std::filesystem::directory_entry stdEntry(toStdString(newFilePath));
     FSEntry FSEntry(newFilePath, newFileName, stdEntry.file_size(), stdEntry.last_write_time(), stdEntry.is_directory());
-    insert_sorted(fileEntryVec, FSEntry, std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+    int newIndex = fileEntryList.insert(FSEntry);
     qDebug() << "fileRen" << oldFilePath << newFilePath;
-    emit fileRenamed(oldFilePath, oldIndex, newFilePath, indexOfFile(newFilePath));
+    emit fileRenamed(oldFilePath, oldIndex, newFilePath, newIndex);
 }
 
 // ---- dir entries
@@ -490,6 +705,7 @@ bool DirectoryManager::insertDirEntry(const QString &dirPath) {
     FSEntry.path = dirPath;
     FSEntry.isDirectory = true;
     insert_sorted(dirEntryVec, FSEntry, std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+    updateDirEntryCharge();
     qDebug() << "dirIns" << dirPath;
     emit dirAdded(dirPath);
     return true;
@@ -500,6 +716,7 @@ void DirectoryManager::removeDirEntry(const QString &dirPath) {
         return;
     int index = indexOfDir(dirPath);
     dirEntryVec.erase(dirEntryVec.begin() + index);
+    updateDirEntryCharge();
     qDebug() << "dirRem" << dirPath;
     emit dirRemoved(dirPath, index);
 }
@@ -519,6 +736,7 @@ void DirectoryManager::renameDirEntry(const QString &oldDirPath, const QString &
     FSEntry.path = newDirPath;
     FSEntry.isDirectory = true;
     insert_sorted(dirEntryVec, FSEntry, std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+    updateDirEntryCharge();
     qDebug() << "dirRen" << oldDirPath << newDirPath;
     emit dirRenamed(oldDirPath, oldIndex, newDirPath, indexOfDir(newDirPath));
 }
@@ -530,7 +748,7 @@ FileListSource DirectoryManager::source() const {
 
 QStringList DirectoryManager::fileList() const {
     QStringList list;
-    for(auto const& value : fileEntryVec)
+    for(auto const& value : fileEntryList)
         list << value.path;
     return list;
 }
@@ -544,6 +762,110 @@ bool DirectoryManager::fileWatcherActive() {
 //----------------------------------------------------------------------------
 // fs watcher events  ( onFile___External() )
 // these take file NAMES, not paths
+
+// Small batches are replayed event by event, big ones go through applyBulkUpdate()
+void DirectoryManager::onWatcherChanges(const QVector<WatcherChange> &changes) {
+    if(mListSource == SOURCE_DIRECTORY_RECURSIVE) {
+        applyRecursiveChanges(changes);
+        return;
+    }
+    if(changes.count() < BULK_UPDATE_THRESHOLD) {
+        for(auto const &change : changes) {
+            switch(change.type) {
+            case WatcherChange::Created:
+                onFileAddedExternal(change.name);
+                break;
+            case WatcherChange::Deleted:
+                onFileRemovedExternal(change.name);
+                break;
+            case WatcherChange::Renamed:
+                onFileRenamedExternal(change.name, change.newName);
+                break;
+            case WatcherChange::Modified:
+                onFileModifiedExternal(change.name);
+                break;
+            }
+        }
+        return;
+    }
+    QString dirPath = watcher->watchPath() + "/";
+    QSet<QString> paths;
+    QHash<QString, QString> renames;
+    for(auto const &change : changes) {
+        paths.insert(dirPath + change.name);
+        if(change.type == WatcherChange::Renamed) {
+            paths.insert(dirPath + change.newName);
+            renames.insert(dirPath + change.name, dirPath + change.newName);
+        }
+    }
+    applyBulkUpdate(paths, renames);
+}
+// Names here are relative to the root and may point into subdirectories.
+// Directories are expanded into the files they contain:
+//   appeared  - its files are read from disk. This also catches files created
+//               before the watcher managed to set up a watch for it.
+//   gone      - every entry under that path gets re-checked.
+// Gone files are just re-checked themselves.
+void DirectoryManager::applyRecursiveChanges(const QVector<WatcherChange> &changes) {
+    QString rootPath = watcher->watchPath() + "/";
+    QSet<QString> paths, goneDirs;
+    for(auto const &change : changes) {
+        QString path = rootPath + change.name;
+        if(change.type == WatcherChange::Deleted) {
+            if(change.isDir)
+                goneDirs.insert(path);
+            paths.insert(path);
+            continue;
+        }
+        if(change.type == WatcherChange::Renamed) {
+            QString newPath = rootPath + change.newName;
+            // plain file rename within the same directory
+            if(!change.isDir && isFile(newPath) && containsFile(path) &&
+               QFileInfo(path).absolutePath() == QFileInfo(newPath).absolutePath())
+            {
+                renameFileEntry(path, QFileInfo(newPath).fileName());
+                continue;
+            }
+            if(change.isDir)
+                goneDirs.insert(path);
+            paths.insert(path);
+            path = newPath;
+        }
+        if(isDir(path)) {
+            std::vector<FSEntry> found;
+            try {
+                DirectoryScanner::scanRecursive(path, filter, found);
+            } catch (const std::filesystem::filesystem_error &err) {
+                qDebug() << "[DirectoryManager]" << err.what();
+            }
+            for(auto const &entry : found)
+                paths.insert(entry.path);
+        } else {
+            paths.insert(path);
+        }
+    }
+    if(!goneDirs.isEmpty()) {
+        for(auto const &entry : fileEntryList) {
+            QString parent = entry.path.left(entry.path.lastIndexOf('/'));
+            while(parent.length() >= rootPath.length()) {
+                if(goneDirs.contains(parent)) {
+                    paths.insert(entry.path);
+                    break;
+                }
+                parent = parent.left(parent.lastIndexOf('/'));
+            }
+        }
+    }
+    refreshEntries(paths);
+}
+
+// some events were lost; re-read everything in background
+void DirectoryManager::onWatcherRescanRequired() {
+    if(mListSource == SOURCE_LIST)
+        return;
+    startRescan(mDirectoryPath, mListSource == SOURCE_DIRECTORY_RECURSIVE);
+}
+
 void DirectoryManager::onFileRemovedExternal(QString fileName) {
     QString fullPath = watcher->watchPath() + "/" + fileName;
     removeDirEntry(fullPath);
@@ -8,6 +8,9 @@
 #include <QDebug>
 #include <QDateTime>
 #include <QRegularExpression>
+#include <QThreadPool>
+#include <QHash>
+#include <QSet>
 
 #include <vector>
 #include <string>
@@ -17,6 +20,10 @@
 
 #include "settings.h"
 #include "watchers/directorywatcher.h"
+#include "directoryscanner.h"
+#include "directorysnapshot.h"
+#include "extensionfilter.h"
+#include "sortedentrylist.h"
 #include "utils/stuff.h"
 #include "sourcecontainers/fsentry.h"
 
@@ -26,6 +33,18 @@ enum FileListSource { // rename? wip
     SOURCE_LIST
 };
 
+// Result of a bulk update. Sent instead of per-entry signals
+// when a lot of entries change at once.
+struct DirectoryChanges {
+    QStringList removedFiles;
+    QVector<int> removedFileIndexes; // positions before the update
+    QStringList addedFiles;
+    QVector<QPair<QString, QString>> renamedFiles; // (from, to); not in removed / added
+    QStringList modifiedFiles;
+    QStringList removedDirs;
+    QStringList addedDirs;
+};
+
 class DirectoryManager;
 
 typedef bool (DirectoryManager::*CompareFunction)(const FSEntry &e1, const FSEntry &e2) const;
@@ -87,17 +106,23 @@ public:
     QStringList fileList() const;
 
 private:
-    QRegularExpression regex;
+    ExtensionFilter filter;
     QCollator collator;
-    std::vector<FSEntry> fileEntryVec, dirEntryVec;
+    SortedEntryList fileEntryList;
+    std::vector<FSEntry> dirEntryVec;
+    MemoryCharge dirEntryCharge{MEM_FILE_ENTRIES};
     const FSEntry defaultEntry;
     QString mDirectoryPath;
 
     DirectoryWatcher* watcher;
+    DirectorySnapshot snapshot;
+    DirectoryScanner *rescanTask;
     void readSettings();
     SortingMode mSortingMode;
     FileListSource mListSource;
     void loadEntryList(QString directoryPath, bool recursive);
+    void sortDirEntries();
+    void updateDirEntryCharge();
 
     bool path_entry_compare(const FSEntry &e1, const FSEntry &e2) const;
     bool path_entry_compare_reverse(const FSEntry &e1, const FSEntry &e2) const;
@@ -108,15 +133,24 @@ private:
     CompareFunction compareFunction();
     bool size_entry_compare(const FSEntry &e1, const FSEntry &e2) const;
     bool size_entry_compare_reverse(const FSEntry &e1, const FSEntry &e2) const;
-    void startFileWatcher(QString directoryPath);
+    void startFileWatcher(QString directoryPath, bool recursive);
     void stopFileWatcher();
 
-    void addEntriesFromDirectory(std::vector<FSEntry> &entryVec, QString directoryPath);
-    void addEntriesFromDirectoryRecursive(std::vector<FSEntry> &entryVec, QString directoryPath);
+    QString sortKey() const;
+    void startRescan(QString dirPath, bool recursive);
+    void cancelRescan();
+    void refreshEntry(const QString &path);
+    bool refreshEntries(const QSet<QString> &paths);
+    // renames: from -> to, as paired by the watcher
+    bool applyBulkUpdate(const QSet<QString> &paths, const QHash<QString, QString> &renames = QHash<QString, QString>());
+    void applyRecursiveChanges(const QVector<WatcherChange> &changes);
     bool checkFileRange(int index) const;
     bool checkDirRange(int index) const;
 
 private slots:
+    void onRescanFinished();
+    void onWatcherChanges(const QVector<WatcherChange> &changes);
+    void onWatcherRescanRequired();
     void onFileAddedExternal(QString fileName);
     void onFileRemovedExternal(QString fileName);
     void onFileModifiedExternal(QString fileName);
@@ -129,8 +163,13 @@ signals:
     void fileModified(QString filePath);
     void fileAdded(QString filePath);
     void fileRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo);
+    // same file, new position in the sorted list (e.g. its date changed)
+    void fileMoved(QString filePath, int indexFrom, int indexTo);
 
     void dirRemoved(QString dirPath, int);
     void dirAdded(QString dirPath);
     void dirRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo);
+
+    void bulkChangeStarted();
+    void bulkChanged(const DirectoryChanges &changes);
 };
@@ -0,0 +1,83 @@
+#include "directoryscanner.h"
+#include "utils/tracer.h"
+
+namespace fs = std::filesystem;
+
+DirectoryScanner::DirectoryScanner(QString _path, ExtensionFilter _filter, bool _recursive)
+    : path(_path), recursive(_recursive), filter(_filter)
+{
+}
+
+void DirectoryScanner::run() {
+    try {
+        if(recursive)
+            scanRecursive(path, filter, fileEntries);
+        else
+            scan(path, filter, fileEntries, dirEntries);
+    } catch (const std::filesystem::filesystem_error &err) {
+        qDebug() << "[DirectoryScanner]" << err.what();
+    }
+    emit finished();
+}
+
+// both directories & files
+void DirectoryScanner::scan(const QString &dirPath, const ExtensionFilter &filter, std::vector<FSEntry> &files, std::vector<FSEntry> &dirs) {
+    TRACE_SCOPE("DirectoryScanner::scan", "directory");
+    for(const auto & entry : fs::directory_iterator(toStdString(dirPath))) {
+        // check the name before converting anything
+        std::string fileName = entry.path().filename().generic_string();
+#ifndef Q_OS_WIN32
+        // ignore hidden files
+        if(fileName[0] == '.')
+            continue;
+#endif
+        if(entry.is_directory()) { // this can still throw std::bad_alloc ..
+            FSEntry newEntry;
+            try {
+                newEntry.name = QString::fromStdString(fileName);
+                newEntry.path = QString::fromStdString(entry.path().generic_string());
+                newEntry.isDirectory = true;
+                //newEntry.size = entry.file_size();
+                //newEntry.modifyTime = entry.last_write_time();
+            } catch (const std::filesystem::filesystem_error &err) {
+                qDebug() << "[DirectoryScanner]" << err.what();
+                continue;
+            }
+            dirs.emplace_back(newEntry);
+        } else if (filter.matches(fileName)) {
+            FSEntry newEntry;
+            try {
+                newEntry.name = QString::fromStdString(fileName);
+                newEntry.path = QString::fromStdString(entry.path().generic_string());
+                newEntry.isDirectory = false;
+                newEntry.size = entry.file_size();
+                newEntry.modifyTime = entry.last_write_time();
+            } catch (const std::filesystem::filesystem_error &err) {
+                qDebug() << "[DirectoryScanner]" << err.what();
+                continue;
+            }
+            files.emplace_back(newEntry);
+        }
+    }
+}
+
+void DirectoryScanner::scanRecursive(const QString &dirPath, const ExtensionFilter &filter, std::vector<FSEntry> &files) {
+    TRACE_SCOPE("DirectoryScanner::scanRecursive", "directory");
+    for(const auto & entry : fs::recursive_directory_iterator(toStdString(dirPath))) {
+        std::string fileName = entry.path().filename().generic_string();
+        if(!entry.is_directory() && filter.matches(fileName)) {
+            FSEntry newEntry;
+            try {
+                newEntry.name = QString::fromStdString(fileName);
+                newEntry.path = QString::fromStdString(entry.path().generic_string());
+                newEntry.isDirectory = false;
+                newEntry.size = entry.file_size();
+                newEntry.modifyTime = entry.last_write_time();
+            } catch (const std::filesystem::filesystem_error &err) {
+                qDebug() << "[DirectoryScanner]" << err.what();
+                continue;
+            }
+            files.emplace_back(newEntry);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+#include <QDebug>
+#include <vector>
+#include <filesystem>
+#include "sourcecontainers/fsentry.h"
+#include "extensionfilter.h"
+#include "utils/stuff.h"
+
+// Reads directory contents. Can be run directly via scan() or in a thread pool.
+class DirectoryScanner : public QObject, public QRunnable {
+    Q_OBJECT
+public:
+    DirectoryScanner(QString _path, ExtensionFilter _filter, bool _recursive = false);
+    void run();
+    static void scan(const QString &dirPath, const ExtensionFilter &filter, std::vector<FSEntry> &files, std::vector<FSEntry> &dirs);
+    static void scanRecursive(const QString &dirPath, const ExtensionFilter &filter, std::vector<FSEntry> &files);
+
+    QString path;
+    bool recursive;
+    std::vector<FSEntry> fileEntries, dirEntries;
+
+private:
+    ExtensionFilter filter;
+
+signals:
+    void finished();
+};
@@ -0,0 +1,130 @@
+#include "directorysnapshot.h"
+#include "settings.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace fs = std::filesystem;
+
+#define SNAPSHOT_MAGIC   0x71444c53 // "qDLS"
+#define SNAPSHOT_VERSION 1
+
+DirectorySnapshot::DirectorySnapshot() {
+    cacheDirPath = settings->tmpDir() + "dirsnapshots/";
+    QDir().mkpath(cacheDirPath);
+}
+
+QString DirectorySnapshot::snapshotPath(const QString &dirPath) const {
+    return cacheDirPath + QString(QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+bool DirectorySnapshot::directoryStamp(const QString &dirPath, qint64 &mtime, quint64 &inode) const {
+    std::error_code ec;
+    auto lastWrite = fs::last_write_time(toStdString(dirPath), ec);
+    if(ec)
+        return false;
+    mtime = lastWrite.time_since_epoch().count();
+    inode = 0;
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if(stat(dirPath.toLocal8Bit().constData(), &st) != 0)
+        return false;
+    inode = st.st_ino;
+#endif
+    return true;
+}
+
+bool DirectorySnapshot::read(const QString &dirPath, const QString &sortKey, std::vector<FSEntry> &files, std::vector<FSEntry> &dirs, bool &isSorted) {
+    isSorted = false;
+    qint64 mtime;
+    quint64 inode;
+    if(!directoryStamp(dirPath, mtime, inode))
+        return false;
+    QFile file(snapshotPath(dirPath));
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, fileCount, dirCount;
+    quint16 version;
+    qint64 savedMtime;
+    quint64 savedInode;
+    QString savedPath, savedSortKey;
+    in >> magic >> version;
+    if(magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION)
+        return false;
+    in >> savedPath >> savedMtime >> savedInode;
+    // directory was changed (or replaced) since the last visit
+    if(savedPath != dirPath || savedMtime != mtime || savedInode != inode)
+        return false;
+    in >> savedSortKey;
+
+    // entry paths are stored as names relative to the directory
+    QString prefix = dirPath.endsWith("/") ? dirPath : dirPath + "/";
+    QString name;
+    in >> dirCount;
+    if(in.status() != QDataStream::Ok)
+        return false;
+    std::vector<FSEntry> newDirs;
+    newDirs.reserve(dirCount);
+    for(quint32 i = 0; i < dirCount && in.status() == QDataStream::Ok; i++) {
+        in >> name;
+        newDirs.emplace_back(prefix + name, name, true);
+    }
+    in >> fileCount;
+    if(in.status() != QDataStream::Ok)
+        return false;
+    std::vector<FSEntry> newFiles;
+    newFiles.reserve(fileCount);
+    quint64 size;
+    qint64 fileMtime;
+    for(quint32 i = 0; i < fileCount && in.status() == QDataStream::Ok; i++) {
+        in >> name >> size >> fileMtime;
+        newFiles.emplace_back(prefix + name, name, size,
+                              fs::file_time_type(fs::file_time_type::duration(fileMtime)), false);
+    }
+    if(in.status() != QDataStream::Ok) {
+        qDebug() << "[DirectorySnapshot] Error - corrupted snapshot for" << dirPath;
+        return false;
+    }
+    files.swap(newFiles);
+    dirs.swap(newDirs);
+    isSorted = (savedSortKey == sortKey);
+    return true;
+}
+
+bool DirectorySnapshot::write(const QString &dirPath, const QString &sortKey, const SortedEntryList &files, const std::vector<FSEntry> &dirs) {
+    if(files.size() + dirs.size() < SNAPSHOT_MIN_ENTRIES) {
+        // don't keep outdated stuff around
+        remove(dirPath);
+        return false;
+    }
+    qint64 mtime;
+    quint64 inode;
+    if(!directoryStamp(dirPath, mtime, inode))
+        return false;
+    QSaveFile file(snapshotPath(dirPath));
+    if(!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "[DirectorySnapshot] Error - could not write" << file.fileName();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << quint32(SNAPSHOT_MAGIC) << quint16(SNAPSHOT_VERSION);
+    out << dirPath << mtime << inode << sortKey;
+    out << quint32(dirs.size());
+    for(auto const &entry : dirs)
+        out << entry.name;
+    out << quint32(files.size());
+    for(auto const &entry : files)
+        out << entry.name << quint64(entry.size) << qint64(entry.modifyTime.time_since_epoch().count());
+    return file.commit();
+}
+
+void DirectorySnapshot::remove(const QString &dirPath) {
+    QString path = snapshotPath(dirPath);
+    if(QFile::exists(path))
+        QFile::remove(path);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QString>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <vector>
+#include <filesystem>
+#include "sourcecontainers/fsentry.h"
+#include "sortedentrylist.h"
+#include "utils/stuff.h"
+
+// Minimum entry count for a directory listing to be saved.
+// Smaller directories are cheap enough to just re-read.
+#define SNAPSHOT_MIN_ENTRIES 500
+
+// On-disk cache of directory listings.
+// A snapshot is valid as long as the directory's mtime & inode are unchanged,
+// which means no entries were added, removed or renamed since it was written.
+// File metadata (size, mtime) may still be stale, so the caller is expected to
+// reconcile it with a rescan.
+class DirectorySnapshot {
+public:
+    DirectorySnapshot();
+    // isSorted is set if the entries were saved with the same sortKey
+    bool read(const QString &dirPath, const QString &sortKey, std::vector<FSEntry> &files, std::vector<FSEntry> &dirs, bool &isSorted);
+    bool write(const QString &dirPath, const QString &sortKey, const SortedEntryList &files, const std::vector<FSEntry> &dirs);
+    void remove(const QString &dirPath);
+
+private:
+    QString snapshotPath(const QString &dirPath) const;
+    bool directoryStamp(const QString &dirPath, qint64 &mtime, quint64 &inode) const;
+    QString cacheDirPath;
+};
@@ -0,0 +1,54 @@
+#include "extensionfilter.h"
+#include <algorithm>
+
+ExtensionFilter::ExtensionFilter() : maxLength(0) {
+}
+
+void ExtensionFilter::setFormats(const QList<QByteArray> &formats) {
+    extensions.clear();
+    maxLength = 0;
+    for(auto const &format : formats) {
+        std::string ext = format.toLower().toStdString();
+        if(ext.empty())
+            continue;
+        maxLength = std::max(maxLength, ext.length());
+        extensions.insert(ext);
+    }
+}
+
+// Copies the lowercased extension into ext.
+// Fails if there is none, if it is longer than any supported one or if it
+// contains non-ASCII characters (no known format has them), so the usual
+// ASCII names never go through unicode case folding.
+template<typename T>
+static bool extractExtension(const T *str, size_t length, size_t maxLength, std::string &ext) {
+    size_t start = length;
+    while(start > 0 && str[start - 1] != '.') {
+        if(str[start - 1] == '/')
+            return false;
+        start--;
+    }
+    size_t extLength = length - start;
+    if(start == 0 || extLength == 0 || extLength > maxLength)
+        return false;
+    ext.resize(extLength);
+    for(size_t i = 0; i < extLength; i++) {
+        auto c = str[start + i];
+        if(c >= 0x80)
+            return false;
+        ext[i] = static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+    }
+    return true;
+}
+
+bool ExtensionFilter::matches(const QString &fileName) const {
+    std::string ext;
+    return extractExtension(fileName.utf16(), static_cast<size_t>(fileName.size()), maxLength, ext) &&
+           extensions.count(ext);
+}
+
+bool ExtensionFilter::matches(const std::string &fileName) const {
+    std::string ext;
+    return extractExtension(reinterpret_cast<const unsigned char*>(fileName.data()), fileName.size(), maxLength, ext) &&
+           extensions.count(ext);
+}
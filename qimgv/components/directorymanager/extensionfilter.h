@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <string>
+#include <unordered_set>
+
+// Checks file names against a set of supported extensions.
+// Much cheaper than a regex with every format in it, which adds up when
+// listing large directories.
+class ExtensionFilter {
+public:
+    ExtensionFilter();
+    void setFormats(const QList<QByteArray> &formats);
+    // accepts a file name or a full path
+    bool matches(const QString &fileName) const;
+    bool matches(const std::string &fileName) const;
+
+private:
+    std::unordered_set<std::string> extensions; // lowercase
+    size_t maxLength;
+};
@@ -0,0 +1,250 @@
+#include "sortedentrylist.h"
+#include "utils/tracer.h"
+
+// chunk is split in half when it grows past CHUNK_MAX
+#define CHUNK_MAX  1024
+#define CHUNK_FILL 512
+
+SortedEntryList::SortedEntryList()
+    : count(0),
+      charge(MEM_FILE_ENTRIES)
+{
+}
+
+// a copy in the chunk & one in the lookup hash, sharing the strings
+qint64 SortedEntryList::entryBytes(const FSEntry &entry) {
+    return entry.memoryBytes() + sizeof(FSEntry);
+}
+
+SortedEntryList::const_iterator &SortedEntryList::const_iterator::operator++() {
+    if(++pos >= list->chunks[chunk].size()) {
+        chunk++;
+        pos = 0;
+    }
+    return *this;
+}
+
+void SortedEntryList::setCompare(Compare cmp) {
+    compare = cmp;
+}
+
+void SortedEntryList::assign(std::vector<FSEntry> &&entries, bool isSorted) {
+    if(!isSorted) {
+        TRACE_SCOPE("SortedEntryList sort", "directory");
+        std::sort(entries.begin(), entries.end(), compare);
+    }
+    lookup.clear();
+    lookup.reserve(entries.size());
+    qint64 bytes = 0;
+    for(auto const &entry : entries) {
+        lookup.insert(entry.path, entry);
+        bytes += entryBytes(entry);
+    }
+    charge.set(bytes);
+    fillChunks(std::move(entries));
+}
+
+void SortedEntryList::sort() {
+    TRACE_SCOPE("SortedEntryList sort", "directory");
+    std::vector<FSEntry> entries;
+    entries.reserve(count);
+    for(auto &chunk : chunks)
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(entries));
+    std::sort(entries.begin(), entries.end(), compare);
+    fillChunks(std::move(entries));
+}
+
+void SortedEntryList::clear() {
+    chunks.clear();
+    tree.clear();
+    lookup.clear();
+    count = 0;
+    charge.set(0);
+}
+
+void SortedEntryList::fillChunks(std::vector<FSEntry> &&entries) {
+    chunks.clear();
+    count = static_cast<int>(entries.size());
+    for(size_t i = 0; i < entries.size(); i += CHUNK_FILL) {
+        size_t last = std::min(entries.size(), i + CHUNK_FILL);
+        chunks.emplace_back(std::make_move_iterator(entries.begin() + i),
+                            std::make_move_iterator(entries.begin() + last));
+    }
+    rebuildTree();
+}
+
+// ----------------------------------------------------------------- fenwick
+
+void SortedEntryList::rebuildTree() {
+    tree.assign(chunks.size() + 1, 0);
+    for(size_t i = 1; i <= chunks.size(); i++) {
+        tree[i] += static_cast<int>(chunks[i - 1].size());
+        size_t parent = i + (i & (~i + 1));
+        if(parent <= chunks.size())
+            tree[parent] += tree[i];
+    }
+}
+
+void SortedEntryList::treeAdd(size_t chunk, int delta) {
+    for(size_t i = chunk + 1; i < tree.size(); i += (i & (~i + 1)))
+        tree[i] += delta;
+}
+
+// number of entries in chunks before this one
+int SortedEntryList::prefixCount(size_t chunk) const {
+    int sum = 0;
+    for(size_t i = chunk; i > 0; i -= (i & (~i + 1)))
+        sum += tree[i];
+    return sum;
+}
+
+void SortedEntryList::locate(int index, size_t &chunk, size_t &pos) const {
+    size_t node = 0;
+    size_t step = 1;
+    while(step * 2 < tree.size())
+        step *= 2;
+    int remaining = index;
+    for(; step > 0; step /= 2) {
+        if(node + step < tree.size() && tree[node + step] <= remaining) {
+            node += step;
+            remaining -= tree[node];
+        }
+    }
+    chunk = node;
+    pos = static_cast<size_t>(remaining);
+}
+
+// ----------------------------------------------------------------- search
+
+// upper: first chunk whose last entry is greater than the given one (insertion)
+// lower: first chunk whose last entry is not less than the given one (lookup)
+size_t SortedEntryList::chunkFor(const FSEntry &entry, bool upper) const {
+    size_t lo = 0, hi = chunks.size();
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        bool goRight = upper ? !compare(entry, chunks[mid].back())
+                             : compare(chunks[mid].back(), entry);
+        if(goRight)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+bool SortedEntryList::position(const FSEntry &entry, size_t &chunk, size_t &pos) const {
+    chunk = chunkFor(entry, false);
+    if(chunk >= chunks.size())
+        return false;
+    auto &c = chunks[chunk];
+    auto it = std::lower_bound(c.begin(), c.end(), entry, compare);
+    if(it == c.end() || it->path != entry.path)
+        return false;
+    pos = static_cast<size_t>(it - c.begin());
+    return true;
+}
+
+// ----------------------------------------------------------------- modify
+
+void SortedEntryList::splitChunk(size_t chunk) {
+    auto &c = chunks[chunk];
+    std::vector<FSEntry> upperHalf(std::make_move_iterator(c.begin() + c.size() / 2),
+                                   std::make_move_iterator(c.end()));
+    c.resize(c.size() / 2);
+    chunks.insert(chunks.begin() + chunk + 1, std::move(upperHalf));
+    rebuildTree();
+}
+
+int SortedEntryList::insert(const FSEntry &entry) {
+    if(lookup.contains(entry.path))
+        remove(entry.path);
+    lookup.insert(entry.path, entry);
+    charge.set(charge.bytes() + entryBytes(entry));
+    count++;
+    if(chunks.empty()) {
+        chunks.emplace_back(1, entry);
+        rebuildTree();
+        return 0;
+    }
+    size_t chunk = std::min(chunkFor(entry, true), chunks.size() - 1);
+    auto &c = chunks[chunk];
+    auto it = std::upper_bound(c.begin(), c.end(), entry, compare);
+    int index = prefixCount(chunk) + static_cast<int>(it - c.begin());
+    c.insert(it, entry);
+    treeAdd(chunk, 1);
+    if(c.size() > CHUNK_MAX)
+        splitChunk(chunk);
+    return index;
+}
+
+int SortedEntryList::remove(const QString &path) {
+    auto entry = lookup.constFind(path);
+    if(entry == lookup.constEnd())
+        return -1;
+    size_t chunk, pos;
+    if(!position(entry.value(), chunk, pos))
+        return -1;
+    int index = prefixCount(chunk) + static_cast<int>(pos);
+    charge.set(charge.bytes() - entryBytes(entry.value()));
+    chunks[chunk].erase(chunks[chunk].begin() + pos);
+    count--;
+    if(chunks[chunk].empty()) {
+        chunks.erase(chunks.begin() + chunk);
+        rebuildTree();
+    } else {
+        treeAdd(chunk, -1);
+    }
+    lookup.remove(path);
+    return index;
+}
+
+// ----------------------------------------------------------------- access
+
+int SortedEntryList::indexOf(const QString &path) const {
+    auto entry = lookup.constFind(path);
+    if(entry == lookup.constEnd())
+        return -1;
+    size_t chunk, pos;
+    if(!position(entry.value(), chunk, pos))
+        return -1;
+    return prefixCount(chunk) + static_cast<int>(pos);
+}
+
+bool SortedEntryList::contains(const QString &path) const {
+    return lookup.contains(path);
+}
+
+const FSEntry *SortedEntryList::find(const QString &path) const {
+    auto entry = lookup.constFind(path);
+    return (entry == lookup.constEnd()) ? nullptr : &entry.value();
+}
+
+const FSEntry &SortedEntryList::at(int index) const {
+    size_t chunk, pos;
+    locate(index, chunk, pos);
+    return chunks[chunk][pos];
+}
+
+const FSEntry &SortedEntryList::front() const {
+    return chunks.front().front();
+}
+
+const FSEntry &SortedEntryList::back() const {
+    return chunks.back().back();
+}
+
+int SortedEntryList::size() const {
+    return count;
+}
+
+bool SortedEntryList::empty() const {
+    return count == 0;
+}
+
+SortedEntryList::const_iterator SortedEntryList::begin() const {
+    return const_iterator(this, 0, 0);
+}
+
+SortedEntryList::const_iterator SortedEntryList::end() const {
+    return const_iterator(this, chunks.size(), 0);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include "sourcecontainers/fsentry.h"
+#include "components/metrics/memorymetrics.h"
+
+// Sorted list of FSEntry with O(log n) insert / remove / index lookup.
+//
+// Entries are stored in sorted chunks of up to CHUNK_MAX items.
+// A Fenwick tree over chunk sizes maps a position to its chunk and back,
+// a hash by path gives the sort key needed to find an entry.
+// The comparator must define a strict total order (no two entries equal),
+// otherwise lookups by path may fail.
+//
+// Counted as MEM_FILE_ENTRIES.
+class SortedEntryList {
+public:
+    typedef std::function<bool(const FSEntry &, const FSEntry &)> Compare;
+
+    class const_iterator {
+    public:
+        const_iterator(const SortedEntryList *_list, size_t _chunk, size_t _pos) : list(_list), chunk(_chunk), pos(_pos) {}
+        const FSEntry &operator*() const { return list->chunks[chunk][pos]; }
+        const FSEntry *operator->() const { return &list->chunks[chunk][pos]; }
+        const_iterator &operator++();
+        bool operator==(const const_iterator &other) const { return chunk == other.chunk && pos == other.pos; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    private:
+        const SortedEntryList *list;
+        size_t chunk, pos;
+    };
+
+    SortedEntryList();
+    // does not re-sort; call sort() afterwards
+    void setCompare(Compare cmp);
+    // replaces contents
+    void assign(std::vector<FSEntry> &&entries, bool isSorted);
+    void sort();
+    void clear();
+
+    // returns the position of the new entry
+    int insert(const FSEntry &entry);
+    // returns the old position or -1
+    int remove(const QString &path);
+    int indexOf(const QString &path) const;
+    bool contains(const QString &path) const;
+    // entry with the given path, nullptr if not present
+    const FSEntry *find(const QString &path) const;
+
+    const FSEntry &at(int index) const;
+    const FSEntry &front() const;
+    const FSEntry &back() const;
+    int size() const;
+    bool empty() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    std::vector<std::vector<FSEntry>> chunks;
+    std::vector<int> tree; // fenwick, 1-based, over chunk sizes
+    QHash<QString, FSEntry> lookup;
+    Compare compare;
+    int count;
+    MemoryCharge charge;
+
+    void rebuildTree();
+    void treeAdd(size_t chunk, int delta);
+    int prefixCount(size_t chunk) const;
+    void locate(int index, size_t &chunk, size_t &pos) const;
+    size_t chunkFor(const FSEntry &entry, bool upper) const;
+    bool position(const FSEntry &entry, size_t &chunk, size_t &pos) const;
+    void splitChunk(size_t chunk);
+    void fillChunks(std::vector<FSEntry> &&entries);
+    static qint64 entryBytes(const FSEntry &entry);
+};
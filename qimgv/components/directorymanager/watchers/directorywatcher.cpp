@@ -17,11 +17,18 @@
 
 #define TAG         "[DirectoryWatcher]"
 
+// Changes are delivered in batches at most this often.
+// The window is not restarted by new events so a steady stream
+// won't delay delivery indefinitely.
+#define BATCH_WINDOW 100 // ms
+
 DirectoryWatcherPrivate::DirectoryWatcherPrivate(DirectoryWatcher* qq, WatcherWorker* w) :
     q_ptr(qq),
     worker(w),
     workerThread(new QThread())
 {
+    batchTimer.setSingleShot(true);
+    batchTimer.setInterval(BATCH_WINDOW);
 }
 
 DirectoryWatcher::~DirectoryWatcher() {
@@ -52,6 +59,9 @@ DirectoryWatcher *DirectoryWatcher::newInstance()
 void DirectoryWatcher::setWatchPath(const QString& path) {
     Q_D(DirectoryWatcher);
     d->currentDirectory = path;
+    // drop leftovers from the previous path
+    d->batchTimer.stop();
+    d->pendingChanges.clear();
 }
 
 QString DirectoryWatcher::watchPath() const {
@@ -76,6 +86,16 @@ void DirectoryWatcher::stopObserving()
     d->worker->setRunning(false);
 }
 
+void DirectoryWatcher::setRecursive(bool mode) {
+    Q_D(DirectoryWatcher);
+    d->recursive = mode;
+}
+
+bool DirectoryWatcher::isRecursive() const {
+    Q_D(const DirectoryWatcher);
+    return d->recursive;
+}
+
 bool DirectoryWatcher::isObserving()
 {
     Q_D(DirectoryWatcher);
@@ -84,4 +104,33 @@ bool DirectoryWatcher::isObserving()
 
 DirectoryWatcher::DirectoryWatcher(DirectoryWatcherPrivate* ptr) {
     d_ptr = ptr;
+    connect(&d_ptr->batchTimer, &QTimer::timeout, this, &DirectoryWatcher::flushChanges);
+    connect(this, &DirectoryWatcher::fileCreated, this, [this](const QString &name) {
+        queueChange(WatcherChange::Created, name);
+    });
+    connect(this, &DirectoryWatcher::fileDeleted, this, [this](const QString &name, bool isDir) {
+        queueChange(WatcherChange::Deleted, name, "", isDir);
+    });
+    connect(this, &DirectoryWatcher::fileRenamed, this, [this](const QString &oldName, const QString &newName, bool isDir) {
+        queueChange(WatcherChange::Renamed, oldName, newName, isDir);
+    });
+    connect(this, &DirectoryWatcher::fileModified, this, [this](const QString &name) {
+        queueChange(WatcherChange::Modified, name);
+    });
+}
+
+void DirectoryWatcher::queueChange(WatcherChange::Type type, const QString &name, const QString &newName, bool isDir) {
+    Q_D(DirectoryWatcher);
+    d->pendingChanges.append({ type, name, newName, isDir });
+    if(!d->batchTimer.isActive())
+        d->batchTimer.start();
+}
+
+void DirectoryWatcher::flushChanges() {
+    Q_D(DirectoryWatcher);
+    if(d->pendingChanges.isEmpty())
+        return;
+    QVector<WatcherChange> changes;
+    changes.swap(d->pendingChanges);
+    emit changesReady(changes);
 }
@@ -1,9 +1,24 @@
 #pragma once
 
 #include <QObject>
+#include <QVector>
 
 class DirectoryWatcherPrivate;
 
+// A single filesystem change. Names are relative to the watch path.
+struct WatcherChange {
+    enum Type {
+        Created,
+        Deleted,
+        Renamed,
+        Modified
+    };
+    Type type;
+    QString name;
+    QString newName; // Renamed only
+    bool isDir = false; // Deleted & Renamed; set by the linux watcher only
+};
+
 class DirectoryWatcher : public QObject {
     Q_OBJECT
 public:
@@ -14,6 +29,10 @@ public:
     virtual void setWatchPath(const QString& watchPath);
     virtual QString watchPath() const;
     bool isObserving();
+    // also watch subdirectories; applied on the next setWatchPath()
+    // only supported on linux for now
+    void setRecursive(bool mode);
+    bool isRecursive() const;
 
 public Q_SLOTS:
     void observe();
@@ -21,16 +40,25 @@ public Q_SLOTS:
 
 signals:
     void fileCreated(const QString& filePath);
-    void fileDeleted(const QString& filePath);
-    void fileRenamed(const QString& old, const QString& now);
+    void fileDeleted(const QString& filePath, bool isDir = false);
+    void fileRenamed(const QString& old, const QString& now, bool isDir = false);
     void fileModified(const QString& filePath);
 
+    // all changes collected within BATCH_WINDOW, in order of arrival
+    void changesReady(const QVector<WatcherChange> &changes);
+    // some events were dropped (queue overflow); the contents should be re-read
+    void rescanRequired();
+
     void observingStarted();
     void observingStopped();
 
 protected:
     DirectoryWatcher(DirectoryWatcherPrivate *ptr);
     DirectoryWatcherPrivate* d_ptr;
+    void queueChange(WatcherChange::Type type, const QString &name, const QString &newName = "", bool isDir = false);
+
+private slots:
+    void flushChanges();
 
 private:
     Q_DECLARE_PRIVATE(DirectoryWatcher)
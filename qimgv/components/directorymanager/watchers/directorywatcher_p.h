@@ -11,6 +11,7 @@
 #include <QTimerEvent>
 #include <QVariant>
 #include <QSharedPointer>
+#include <QTimer>
 
 class DirectoryWatcherPrivate : public QObject {
     Q_OBJECT
@@ -22,6 +23,9 @@ public:
     QScopedPointer<WatcherWorker> worker;
     QScopedPointer<QThread> workerThread;
     QString currentDirectory;
+    bool recursive = false;
+    QVector<WatcherChange> pendingChanges;
+    QTimer batchTimer;
 
 private:
     Q_DECLARE_PUBLIC(DirectoryWatcher)
@@ -1,6 +1,7 @@
 #include <QTimer>
 
 #include <sys/inotify.h>
+#include <filesystem>
 
 #include "linuxwatcher_p.h"
 #include "linuxworker.h"
@@ -12,43 +13,91 @@
   * Time to wait for rename event. If event take time longer
   * than specified then event will be considered as remove event
   */
-
-// TODO: this may break event order.
-// Implement a proper queue.
 #define EVENT_MOVE_TIMEOUT      150 // ms
+// Modify events for the same file within this time are merged into one
 #define EVENT_MODIFY_TIMEOUT    150 // ms
 
+namespace fs = std::filesystem;
+
 LinuxWatcherPrivate::LinuxWatcherPrivate(LinuxWatcher* qq) :
     DirectoryWatcherPrivate(qq, new LinuxWorker()),
     watcher(-1),
-    watchObject(-1)
+    watchLimitReached(false)
 {
     watcher = inotify_init();
+    queueTimer.setSingleShot(true);
+    connect(&queueTimer, &QTimer::timeout, this, &LinuxWatcherPrivate::processQueue);
+    clock.start();
 }
 
-int LinuxWatcherPrivate::indexOfWatcherEvent(uint cookie) const {
-    for (int i = 0; i < watcherEvents.size(); ++i) {
-        auto event = watcherEvents.at(i);
-        if (event->cookie() == cookie) {
-            return i;
+bool LinuxWatcherPrivate::addWatch(const QString &relPath) {
+    QString path = relPath.isEmpty() ? currentDirectory : currentDirectory + "/" + relPath;
+    int wd = inotify_add_watch(watcher, path.toStdString().data(), INOTIFY_EVENT_MASK);
+    if (wd == -1) {
+        if (errno == ENOSPC) {
+            if (!watchLimitReached)
+                qDebug() << TAG << "Watch limit reached. Increase fs.inotify.max_user_watches to monitor the whole tree.";
+            watchLimitReached = true;
+        } else {
+            qDebug() << TAG << "Error:" << strerror(errno) << path;
         }
+        return false;
+    }
+    // re-adding an existing watch returns the same descriptor
+    watchedDirs.insert(wd, relPath);
+    return true;
+}
+
+void LinuxWatcherPrivate::addWatchesRecursive(const QString &relPath) {
+    if (!addWatch(relPath))
+        return;
+    QString path = relPath.isEmpty() ? currentDirectory : currentDirectory + "/" + relPath;
+    std::error_code ec;
+    fs::recursive_directory_iterator it(path.toStdString(), fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_directory(ec) || it->is_symlink(ec))
+            continue;
+        QString subPath = QString::fromStdString(it->path().generic_string()).mid(currentDirectory.length() + 1);
+        if (!addWatch(subPath))
+            it.disable_recursion_pending();
     }
-    return -1;
 }
 
-int LinuxWatcherPrivate::indexOfWatcherEvent(const QString& name) const {
-    for (int i = 0; i < watcherEvents.size(); ++i) {
-        auto event = watcherEvents.at(i);
-        if (event->name() == name) {
-            return i;
+// removes watches for a directory and everything below it
+void LinuxWatcherPrivate::removeWatchesUnder(const QString &relPath) {
+    QString prefix = relPath + "/";
+    for (auto it = watchedDirs.begin(); it != watchedDirs.end();) {
+        if (it.value() == relPath || it.value().startsWith(prefix)) {
+            inotify_rm_watch(watcher, it.key());
+            it = watchedDirs.erase(it);
+        } else {
+            ++it;
         }
     }
-    return -1;
 }
 
-void LinuxWatcherPrivate::dispatchFilesystemEvent(LinuxFsEvent* e) {
-    Q_Q(LinuxWatcher);
+// inotify watches follow the inode, so only the paths need updating
+void LinuxWatcherPrivate::renameWatches(const QString &oldRelPath, const QString &newRelPath) {
+    QString prefix = oldRelPath + "/";
+    for (auto it = watchedDirs.begin(); it != watchedDirs.end(); ++it) {
+        if (it.value() == oldRelPath)
+            it.value() = newRelPath;
+        else if (it.value().startsWith(prefix))
+            it.value() = newRelPath + it.value().mid(oldRelPath.length());
+    }
+}
+
+void LinuxWatcherPrivate::clearWatches() {
+    for (auto it = watchedDirs.constBegin(); it != watchedDirs.constEnd(); ++it) {
+        int status = inotify_rm_watch(watcher, it.key());
+        if (status == -1)
+            qDebug() << TAG << "Error:" << strerror(errno);
+    }
+    watchedDirs.clear();
+    watchLimitReached = false;
+}
 
+void LinuxWatcherPrivate::dispatchFilesystemEvent(LinuxFsEvent* e) {
     uint dataOffset = 0;
     QScopedPointer<LinuxFsEvent> event(e);
 
@@ -57,104 +106,174 @@ void LinuxWatcherPrivate::dispatchFilesystemEvent(LinuxFsEvent* e) {
         dataOffset += sizeof(inotify_event) + notify_event->len;
 
         int mask        = notify_event->mask;
-        QString name    = notify_event->name;
         uint cookie     = notify_event->cookie;
         bool isDirEvent = mask & IN_ISDIR;
-        
-        // Skip events for directories and files that isn't in filter range
-        /*if((isDirEvent) && !(mask & IN_MOVED_TO) ) {
+
+        if (mask & IN_Q_OVERFLOW) {
+            handleOverflow();
+            continue;
+        }
+        // watch was removed (directory deleted, unmounted or inotify_rm_watch)
+        if (mask & IN_IGNORED) {
+            watchedDirs.remove(notify_event->wd);
             continue;
-        }*/
+        }
+        // event from a watch we already dropped
+        auto dir = watchedDirs.constFind(notify_event->wd);
+        if (dir == watchedDirs.constEnd() || notify_event->len == 0)
+            continue;
+        // names are reported relative to the watch root
+        QString name = dir.value().isEmpty() ? QString(notify_event->name)
+                                             : dir.value() + "/" + notify_event->name;
 
         if (mask & IN_MODIFY) {
             handleModifyEvent(name);
         } else if (mask & IN_CREATE) {
-            handleCreateEvent(name);
+            handleCreateEvent(name, isDirEvent);
         } else if (mask & IN_DELETE) {
-            handleDeleteEvent(name);
+            handleDeleteEvent(name, isDirEvent);
         } else if (mask & IN_MOVED_FROM) {
-            handleMovedFromEvent(name, cookie);
+            handleMovedFromEvent(name, cookie, isDirEvent);
         } else if (mask & IN_MOVED_TO) {
-            handleMovedToEvent(name, cookie);
+            handleMovedToEvent(name, cookie, isDirEvent);
         }
     }
+    processQueue();
+}
+
+// Events were lost. Make sure every directory is watched again
+// and let the listener re-read everything.
+void LinuxWatcherPrivate::handleOverflow() {
+    Q_Q(LinuxWatcher);
+    qDebug() << TAG << "Event queue overflow";
+    if (recursive)
+        addWatchesRecursive("");
+    emit q->rescanRequired();
+}
+
+void LinuxWatcherPrivate::enqueue(const WatcherEvent &event) {
+    eventQueue.push_back(event);
+}
+
+void LinuxWatcherPrivate::clearQueue() {
+    queueTimer.stop();
+    eventQueue.clear();
+    pendingMoves.clear();
+    pendingModifies.clear();
 }
 
 void LinuxWatcherPrivate::handleModifyEvent(const QString &name) {
-    // Find the same event in the list by file name
-    int eventIndex = indexOfWatcherEvent(name);
-    if (eventIndex == -1) {
-        // This is this first modify event for the current file
-        int timerId = startTimer(EVENT_MODIFY_TIMEOUT);
-        auto event = new WatcherEvent(name, timerId, WatcherEvent::Modify);
-        watcherEvents.append(QSharedPointer<WatcherEvent>(event));
-    } else {
-        auto event = watcherEvents.at(eventIndex);
-        // Restart timer again
-        killTimer(event->timerId());
-        int timerId = startTimer(EVENT_MODIFY_TIMEOUT);
-        event->setTimerId(timerId);
+    // Merge into the one already waiting, which starts over at the back:
+    // dispatched once the file was quiet for EVENT_MODIFY_TIMEOUT, without
+    // holding back events for other files meanwhile
+    auto pending = pendingModifies.find(name);
+    if (pending != pendingModifies.end()) {
+        eventQueue.erase(pending.value());
+        pendingModifies.erase(pending);
     }
+    WatcherEvent event(name, WatcherEvent::Modify);
+    event.setDeadline(clock.elapsed() + EVENT_MODIFY_TIMEOUT);
+    enqueue(event);
+    pendingModifies.insert(name, std::prev(eventQueue.end()));
 }
 
-void LinuxWatcherPrivate::handleDeleteEvent(const QString &name) {
-    Q_Q(LinuxWatcher);
-    emit q->fileDeleted(name);
+// Any other event for a file ends merging of its modify events,
+// otherwise a later modify could be reported before this one.
+void LinuxWatcherPrivate::handleDeleteEvent(const QString &name, bool isDir) {
+    if (isDir && recursive)
+        removeWatchesUnder(name);
+    pendingModifies.remove(name);
+    WatcherEvent event(name, WatcherEvent::Delete);
+    event.setIsDir(isDir);
+    enqueue(event);
 }
 
-void LinuxWatcherPrivate::handleCreateEvent(const QString &name) {
-    Q_Q(LinuxWatcher);
-    emit q->fileCreated(name);
+void LinuxWatcherPrivate::handleCreateEvent(const QString &name, bool isDir) {
+    // Files created before this watch is set up are not reported.
+    // Listener is expected to read the new directory's contents.
+    if (isDir && recursive)
+        addWatchesRecursive(name);
+    pendingModifies.remove(name);
+    enqueue(WatcherEvent(name, WatcherEvent::Create));
 }
 
-void LinuxWatcherPrivate::handleMovedFromEvent(const QString &name, uint cookie) {
-    int timerId = startTimer(EVENT_MOVE_TIMEOUT);
-    // Save timer id to find out later which event timer is running
-    auto event = new WatcherEvent(name, cookie, timerId, WatcherEvent::MovedFrom);
-    watcherEvents.append(QSharedPointer<WatcherEvent>(event));
+void LinuxWatcherPrivate::handleMovedFromEvent(const QString &name, uint cookie, bool isDir) {
+    pendingModifies.remove(name);
+    WatcherEvent event(name, cookie, WatcherEvent::MovedFrom);
+    event.setIsDir(isDir);
+    event.setDeadline(clock.elapsed() + EVENT_MOVE_TIMEOUT);
+    enqueue(event);
+    pendingMoves.insert(cookie, std::prev(eventQueue.end()));
 }
 
-void LinuxWatcherPrivate::handleMovedToEvent(const QString &name, uint cookie) {
-    Q_Q(LinuxWatcher);
-
+void LinuxWatcherPrivate::handleMovedToEvent(const QString &name, uint cookie, bool isDir) {
+    pendingModifies.remove(name);
     // Check if file waiting to be renamed
-    int eventIndex = indexOfWatcherEvent(cookie);
-    if (eventIndex == -1) {
+    auto pending = pendingMoves.find(cookie);
+    if (pending == pendingMoves.end()) {
         // No one event waiting for rename so this is a new file
-        emit q->fileCreated(name);
+        if (isDir && recursive)
+            addWatchesRecursive(name);
+        enqueue(WatcherEvent(name, WatcherEvent::Create));
     } else {
-        // Waiting for rename event is found
-        auto watcherEvent = watcherEvents.takeAt(eventIndex);
-        // Kill associated timer
-        killTimer(watcherEvent->timerId());
-        emit q->fileRenamed(watcherEvent->name(), name);
+        // Turn the waiting event into a rename; it keeps its place in queue
+        EventIterator event = pending.value();
+        pendingMoves.erase(pending);
+        event->setType(WatcherEvent::Rename);
+        event->setNewName(name);
+        event->setDeadline(0);
+        if (isDir && recursive)
+            renameWatches(event->name(), name);
     }
 }
 
-void LinuxWatcherPrivate::timerEvent(QTimerEvent *timerEvent) {
+// Dispatches events from the queue head until one that is still waiting
+void LinuxWatcherPrivate::processQueue() {
     Q_Q(LinuxWatcher);
 
-    // Loop through waiting move events
-    int lastIndex = watcherEvents.size() - 1;
-    for (int i = lastIndex; i >= 0; --i) {
-        auto watcherEvent = watcherEvents.at(i);
-
-        if (watcherEvent->timerId() == timerEvent->timerId()) {
-            int type = watcherEvent->type();
-            if (type == WatcherEvent::MovedFrom) {
-                // Rename event didn't happen so treat this event as remove event
-                emit q->fileDeleted(watcherEvent->name());
-            } else if (type == WatcherEvent::Modify) {
-                emit q->fileModified(watcherEvent->name());
-            }
-
-            watcherEvents.removeAt(i);
+    qint64 now = clock.elapsed();
+    while (!eventQueue.empty()) {
+        WatcherEvent &event = eventQueue.front();
+        if (event.deadline() > now) {
+            queueTimer.start(event.deadline() - now);
+            return;
+        }
+        // Copy before popping; signal handlers may call back into us
+        WatcherEvent current = event;
+        if (current.type() == WatcherEvent::MovedFrom)
+            pendingMoves.remove(current.cookie());
+        if (current.type() == WatcherEvent::Modify) {
+            auto pending = pendingModifies.find(current.name());
+            if (pending != pendingModifies.end() && pending.value() == eventQueue.begin())
+                pendingModifies.erase(pending);
+        }
+        eventQueue.pop_front();
+
+        switch (current.type()) {
+        case WatcherEvent::Create:
+            emit q->fileCreated(current.name());
+            break;
+        case WatcherEvent::Delete:
+            emit q->fileDeleted(current.name(), current.isDir());
+            break;
+        case WatcherEvent::MovedFrom:
+            // Rename event didn't happen so treat this event as remove event
+            // If it was a directory, it is no longer ours to watch
+            if (recursive && current.isDir())
+                removeWatchesUnder(current.name());
+            emit q->fileDeleted(current.name(), current.isDir());
+            break;
+        case WatcherEvent::Rename:
+            emit q->fileRenamed(current.name(), current.newName(), current.isDir());
+            break;
+        case WatcherEvent::Modify:
+            emit q->fileModified(current.name());
+            break;
+        default:
             break;
         }
     }
-
-    // Stop timer anyway
-    killTimer(timerEvent->timerId());
+    queueTimer.stop();
 }
 
 LinuxWatcher::LinuxWatcher() : DirectoryWatcher(new LinuxWatcherPrivate(this)) {
@@ -178,27 +297,20 @@ LinuxWatcher::LinuxWatcher() : DirectoryWatcher(new LinuxWatcherPrivate(this)) {
 
 LinuxWatcher::~LinuxWatcher() {
     Q_D(LinuxWatcher);
-    int removeStatusCode = inotify_rm_watch(d->watcher, d->watchObject);
-    if (removeStatusCode != 0) {
-        qDebug() << TAG << "Cannot remove inotify watcher instance:" << strerror(errno);
-    }
+    d->clearWatches();
 }
 
+// In recursive mode every subdirectory gets its own inotify watch.
+// fanotify could watch a whole mount at once, but requires CAP_SYS_ADMIN.
 void LinuxWatcher::setWatchPath(const QString& path) {
     Q_D(LinuxWatcher);
+    d->clearWatches();
+    d->clearQueue();
     DirectoryWatcher::setWatchPath(path);
 
-    // Subscribe for specified filesystem events
-    if (d->watchObject != -1) {
-        int status = inotify_rm_watch(d->watcher, d->watchObject);
-        if (status == -1) {
-            qDebug() << TAG << "Error:" << strerror(errno);
-        }
-    }
-
     // Add new path to be watched by inotify
-    d->watchObject = inotify_add_watch(d->watcher, path.toStdString().data(), INOTIFY_EVENT_MASK);
-    if (d->watchObject == -1) {
-        qDebug() << TAG << "Error:" << strerror(errno);
-    }
+    if (d->recursive)
+        d->addWatchesRecursive("");
+    else
+        d->addWatch("");
 }
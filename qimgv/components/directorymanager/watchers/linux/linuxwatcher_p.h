@@ -7,6 +7,9 @@
 #include <errno.h>
 #include <QDebug>
 #include <QTimer>
+#include <QHash>
+#include <QElapsedTimer>
+#include <list>
 
 class LinuxFsEvent;
 
@@ -15,25 +18,42 @@ class LinuxWatcherPrivate : public DirectoryWatcherPrivate {
 public:
     explicit LinuxWatcherPrivate(LinuxWatcher* qq = 0);
 
-    int indexOfWatcherEvent(uint cookie) const;
-    int indexOfWatcherEvent(const QString& name) const;
+    typedef std::list<WatcherEvent>::iterator EventIterator;
 
     void handleModifyEvent(const QString& name);
-    void handleDeleteEvent(const QString& name);
-    void handleCreateEvent(const QString& name);
-    void handleMovedFromEvent(const QString& name, uint cookie);
-    void handleMovedToEvent(const QString& name, uint cookie);
+    void handleDeleteEvent(const QString& name, bool isDir);
+    void handleCreateEvent(const QString& name, bool isDir);
+    void handleMovedFromEvent(const QString& name, uint cookie, bool isDir);
+    void handleMovedToEvent(const QString& name, uint cookie, bool isDir);
+    void handleOverflow();
+
+    void enqueue(const WatcherEvent& event);
+    void clearQueue();
+
+    // watch management. paths are relative to currentDirectory
+    bool addWatch(const QString& relPath);
+    void addWatchesRecursive(const QString& relPath);
+    void removeWatchesUnder(const QString& relPath);
+    void renameWatches(const QString& oldRelPath, const QString& newRelPath);
+    void clearWatches();
 
     int watcher;
-    int watchObject;
-
-    QVector<QSharedPointer<WatcherEvent>> watcherEvents;
-
-protected:
-    virtual void timerEvent(QTimerEvent* timerEvent) override;
+    // watch descriptor -> directory path relative to the watch root ("" for the root)
+    QHash<int, QString> watchedDirs;
+    bool watchLimitReached;
+
+    // Events are dispatched strictly in arrival order. The head of the queue
+    // may wait for its deadline (move pairing, modify coalescing), holding
+    // back everything behind it. So a single timer for the head is enough.
+    std::list<WatcherEvent> eventQueue;
+    QHash<uint, EventIterator> pendingMoves;        // by cookie
+    QHash<QString, EventIterator> pendingModifies;  // by name
+    QTimer queueTimer;
+    QElapsedTimer clock;
 
 private slots:
     void dispatchFilesystemEvent(LinuxFsEvent *e);
+    void processQueue();
 
 private:
     Q_DECLARE_PUBLIC(LinuxWatcher)
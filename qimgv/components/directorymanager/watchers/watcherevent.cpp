@@ -1,18 +1,21 @@
 #include <QDebug>
 #include "watcherevent.h"
 
-WatcherEvent::WatcherEvent(const QString &name, int timerId, WatcherEvent::Type type) :
+WatcherEvent::WatcherEvent(const QString &name, WatcherEvent::Type type) :
     mName(name),
-    mTimerId(timerId),
-    mType(type)
+    mCookie(0),
+    mDeadline(0),
+    mType(type),
+    mIsDir(false)
 {
 }
 
-WatcherEvent::WatcherEvent(const QString& name, uint cookie, int timerId, Type type) :
+WatcherEvent::WatcherEvent(const QString& name, uint cookie, Type type) :
     mName(name),
     mCookie(cookie),
-    mTimerId(timerId),
-    mType(type)
+    mDeadline(0),
+    mType(type),
+    mIsDir(false)
 {
 }
 
@@ -27,6 +30,14 @@ void WatcherEvent::setName(const QString &name) {
     mName = name;
 }
 
+QString WatcherEvent::newName() const {
+    return mNewName;
+}
+
+void WatcherEvent::setNewName(const QString &newName) {
+    mNewName = newName;
+}
+
 WatcherEvent::Type WatcherEvent::type() const {
     return mType;
 }
@@ -35,12 +46,12 @@ void WatcherEvent::setType(WatcherEvent::Type type) {
     mType = type;
 }
 
-int WatcherEvent::timerId() const {
-    return mTimerId;
+qint64 WatcherEvent::deadline() const {
+    return mDeadline;
 }
 
-void WatcherEvent::setTimerId(int timerId) {
-    mTimerId = timerId;
+void WatcherEvent::setDeadline(qint64 deadline) {
+    mDeadline = deadline;
 }
 
 uint WatcherEvent::cookie() const {
@@ -50,3 +61,11 @@ uint WatcherEvent::cookie() const {
 void WatcherEvent::setCookie(uint cookie) {
     mCookie = cookie;
 }
+
+bool WatcherEvent::isDir() const {
+    return mIsDir;
+}
+
+void WatcherEvent::setIsDir(bool isDir) {
+    mIsDir = isDir;
+}
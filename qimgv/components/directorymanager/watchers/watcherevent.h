@@ -6,31 +6,41 @@ class WatcherEvent {
 public:
     enum Type {
         None,
-        MovedFrom,
-        MovedTo,
+        Create,
+        Delete,
+        MovedFrom,  // waiting for the matching MovedTo
+        Rename,     // paired MovedFrom + MovedTo
         Modify
     };
 
-    WatcherEvent(const QString &name,int timerId, Type type = None);
-    WatcherEvent(const QString& name, uint cookie, int timerId, Type type = None);
+    WatcherEvent(const QString &name, Type type = None);
+    WatcherEvent(const QString& name, uint cookie, Type type = None);
     ~WatcherEvent();
 
     QString name() const;
     void setName(const QString& name);
 
+    QString newName() const;
+    void setNewName(const QString& newName);
+
     uint cookie() const;
     void setCookie(uint cookie);
 
-    int timerId() const;
-    void setTimerId(int timerId);
+    // event is held in queue until this point (ms), 0 - dispatch right away
+    qint64 deadline() const;
+    void setDeadline(qint64 deadline);
 
     Type type() const;
     void setType(Type type);
 
+    bool isDir() const;
+    void setIsDir(bool isDir);
+
 private:
-    QString mName;
+    QString mName, mNewName;
     uint mCookie;
-    int mTimerId;
+    qint64 mDeadline;
     Type mType;
+    bool mIsDir;
 
 };
@@ -1,23 +1,32 @@
 #include "directorymodel.h"
+#include "cache/bufferpool.h"
+
+// how many files ahead to keep undecoded in memory
+#define READAHEAD_FILES 30
 
 DirectoryModel::DirectoryModel(QObject *parent) :
     QObject(parent),
     fileListSource(SOURCE_DIRECTORY)
 {
-    scaler = new Scaler(&cache);
+    scaler = new Scaler();
 
     connect(&dirManager, &DirectoryManager::fileRemoved,  this, &DirectoryModel::onFileRemoved);
     connect(&dirManager, &DirectoryManager::fileAdded,    this, &DirectoryModel::onFileAdded);
     connect(&dirManager, &DirectoryManager::fileRenamed,  this, &DirectoryModel::onFileRenamed);
     connect(&dirManager, &DirectoryManager::fileModified, this, &DirectoryModel::onFileModified);
+    connect(&dirManager, &DirectoryManager::fileMoved,    this, &DirectoryModel::fileMoved);
     connect(&dirManager, &DirectoryManager::dirRemoved,  this, &DirectoryModel::dirRemoved);
     connect(&dirManager, &DirectoryManager::dirAdded,    this, &DirectoryModel::dirAdded);
     connect(&dirManager, &DirectoryManager::dirRenamed,  this, &DirectoryModel::dirRenamed);
+    connect(&dirManager, &DirectoryManager::bulkChangeStarted, this, &DirectoryModel::bulkChangeStarted);
+    connect(&dirManager, &DirectoryManager::bulkChanged, this, &DirectoryModel::onBulkChanged);
 
     connect(&dirManager, &DirectoryManager::loaded, this, &DirectoryModel::loaded);
     connect(&dirManager, &DirectoryManager::sortingChanged, this, &DirectoryModel::onSortingChanged);
     connect(&loader, &Loader::loadFinished, this, &DirectoryModel::onImageReady);
-    connect(&loader, &Loader::loadFailed, this, &DirectoryModel::loadFailed);
+    connect(&loader, &Loader::loadFailed, this, &DirectoryModel::onLoadFailed);
+    connect(&loader, &Loader::contentsUnused, &readAheadCache, &ReadAheadCache::putBack);
+    connect(&prefetcher, &Prefetcher::statsChanged, this, &DirectoryModel::prefetchStatsChanged);
 }
 
 DirectoryModel::~DirectoryModel() {
@@ -175,6 +184,8 @@ void DirectoryModel::moveFileTo(const QString &srcFile, const QString &destDirPa
 // -----------------------------------------------------------------------------
 bool DirectoryModel::setDirectory(QString path) {
     cache.clear();
+    readAheadCache.clear();
+    prefetcher.clear();
     return dirManager.setDirectory(path);
 }
 
@@ -185,6 +196,7 @@ void DirectoryModel::unload(int index) {
 
 void DirectoryModel::unload(QString filePath) {
     cache.remove(filePath);
+    readAheadCache.remove(filePath);
 }
 
 void DirectoryModel::unloadExcept(QString filePath, bool keepNearby) {
@@ -202,15 +214,31 @@ bool DirectoryModel::loaderBusy() const {
 }
 
 void DirectoryModel::onImageReady(std::shared_ptr<Image> img, const QString &path) {
+    if(!loader.isBusy())
+        prefetcher.resume();
     if(!img) {
         emit loadFailed(path);
         return;
     }
+    // preloaded images only while they fit into the cache budget
+    if(path != currentPath && MemoryMetrics::cacheBudgetLeft() < img->memoryBytes()) {
+        BufferPool::trim();
+        if(MemoryMetrics::cacheBudgetLeft() < img->memoryBytes()) {
+            qDebug() << "[DirectoryModel] cache budget exceeded, dropping" << path;
+            return;
+        }
+    }
     cache.remove(path);
     cache.insert(img);
     emit imageReady(img, path);
 }
 
+void DirectoryModel::onLoadFailed(const QString &path) {
+    if(!loader.isBusy())
+        prefetcher.resume();
+    emit loadFailed(path);
+}
+
 bool DirectoryModel::saveFile(const QString &filePath) {
     return saveFile(filePath, filePath);
 }
@@ -222,6 +250,7 @@ bool DirectoryModel::saveFile(const QString &filePath, const QString &destPath)
     if(img->save(destPath)) {
         if(filePath == destPath) { // replace
             dirManager.updateFileEntry(destPath);
+            cache.refresh(destPath);
             emit fileModified(destPath);
         } else { // manually add if we are saving to the same dir
             QFileInfo fiSrc(filePath);
@@ -251,6 +280,7 @@ void DirectoryModel::onFileAdded(QString filePath) {
 void DirectoryModel::onFileModified(QString filePath) {
     QDateTime modTime = lastModified(filePath);
     if(modTime.isValid()) {
+        readAheadCache.remove(filePath);
         auto img = cache.get(filePath);
         if(img) {
             // check if file on disk is different
@@ -271,6 +301,20 @@ void DirectoryModel::onFileRenamed(QString fromPath, int indexFrom, QString toPa
     emit fileRenamed(fromPath, indexFrom, toPath, indexTo);
 }
 
+void DirectoryModel::onBulkChanged(const DirectoryChanges &changes) {
+    for(auto const &filePath : changes.removedFiles)
+        unload(filePath);
+    for(auto const &rename : changes.renamedFiles)
+        unload(rename.first);
+    for(auto const &filePath : changes.modifiedFiles) {
+        readAheadCache.remove(filePath);
+        auto img = cache.get(filePath);
+        if(img && lastModified(filePath) != img->lastModified())
+            reload(filePath);
+    }
+    emit bulkChanged(changes);
+}
+
 bool DirectoryModel::isLoaded(int index) const {
     return cache.contains(filePathAt(index));
 }
@@ -289,7 +333,7 @@ std::shared_ptr<Image> DirectoryModel::getImageAt(int index) {
 std::shared_ptr<Image> DirectoryModel::getImage(QString filePath) {
     std::shared_ptr<Image> img = cache.get(filePath);
     if(!img)
-        img = loader.load(filePath);
+        img = loader.load(filePath, readAheadCache.take(filePath));
     return img;
 }
 
@@ -299,19 +343,24 @@ void DirectoryModel::updateImage(QString filePath, std::shared_ptr<Image> img) {
             cache.insert(img);
         } else {
             cache.insert(img);
+            cache.refresh(filePath);
             emit imageUpdated(filePath);
         }
     }
 }
 
 void DirectoryModel::load(QString filePath, bool asyncHint) {
-    if(!containsFile(filePath) || loader.isLoading(filePath))
+    if(!containsFile(filePath))
+        return;
+    currentPath = filePath;
+    if(loader.isLoading(filePath))
         return;
     if(!cache.contains(filePath)) {
         if(asyncHint) {
-            loader.loadAsyncPriority(filePath);
+            prefetcher.pause();
+            loader.loadAsyncPriority(filePath, readAheadCache.take(filePath));
         } else {
-            auto img = loader.load(filePath);
+            auto img = loader.load(filePath, readAheadCache.take(filePath));
             if(img) {
                 cache.insert(img);
                 emit imageReady(img, filePath);
@@ -333,6 +382,27 @@ void DirectoryModel::reload(QString filePath) {
 }
 
 void DirectoryModel::preload(QString filePath) {
-    if(containsFile(filePath) && !cache.contains(filePath))
-        loader.loadAsync(filePath);
+    if(MemoryMetrics::cacheBudgetLeft() <= 0)
+        return;
+    if(containsFile(filePath) && !cache.contains(filePath) && !loader.isLoading(filePath)) {
+        prefetcher.pause();
+        loader.loadAsync(filePath, readAheadCache.take(filePath));
+    }
+}
+
+void DirectoryModel::readAhead(QString filePath, QStringList upcoming) {
+    QStringList window;
+    for(auto const &path : upcoming) {
+        if(window.count() == READAHEAD_FILES)
+            break;
+        // already decoded or being decoded
+        if(!cache.contains(path) && !loader.isLoading(path))
+            window.append(path);
+    }
+    readAheadCache.setWindow(window);
+    prefetcher.setWindow(filePath, upcoming);
+}
+
+PrefetchStats DirectoryModel::prefetchStats() {
+    return prefetcher.stats();
 }
@@ -2,6 +2,8 @@
 
 #include <QObject>
 #include "cache/cache.h"
+#include "cache/readaheadcache.h"
+#include "prefetcher/prefetcher.h"
 #include "directorymanager/directorymanager.h"
 #include "scaler/scaler.h"
 #include "loader/loader.h"
@@ -17,6 +19,9 @@ public:
 
     void load(QString filePath, bool asyncHint);
     void preload(QString filePath);
+    // upcoming: files likely to be opened after this one, nearest first
+    void readAhead(QString filePath, QStringList upcoming);
+    PrefetchStats prefetchStats();
 
     int fileCount() const;
     int dirCount() const;
@@ -75,29 +80,39 @@ public:
 signals:
     void fileRemoved(QString filePath, int index);
     void fileRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo);
+    void fileMoved(QString filePath, int indexFrom, int indexTo);
     void fileAdded(QString filePath);
     void fileModified(QString filePath);
     void dirRemoved(QString dirPath, int index);
     void dirRenamed(QString dirPath, int indexFrom, QString toPath, int indexTo);
     void dirAdded(QString dirPath);
+    void bulkChangeStarted();
+    void bulkChanged(const DirectoryChanges &changes);
     void loaded(QString filePath);
     void loadFailed(const QString &path);
     void sortingChanged(SortingMode);
     void indexChanged(int oldIndex, int index);
     void imageReady(std::shared_ptr<Image> img, const QString&);
     void imageUpdated(QString filePath);
+    void prefetchStatsChanged();
 
 private:
     DirectoryManager dirManager;
     Loader loader;
     Cache cache;
+    ReadAheadCache readAheadCache;
+    Prefetcher prefetcher;
     FileListSource fileListSource;
+    // last requested via load(); always cached regardless of the budget
+    QString currentPath;
 
 private slots:
     void onImageReady(std::shared_ptr<Image> img, const QString &path);
+    void onLoadFailed(const QString &path);
     void onSortingChanged();
     void onFileAdded(QString filePath);
     void onFileRemoved(QString filePath, int index);
     void onFileRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo);
     void onFileModified(QString filePath);
+    void onBulkChanged(const DirectoryChanges &changes);
 };
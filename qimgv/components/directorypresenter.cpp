@@ -8,10 +8,13 @@ void DirectoryPresenter::unsetModel() {
     disconnect(model.get(), &DirectoryModel::fileRemoved,  this, &DirectoryPresenter::onFileRemoved);
     disconnect(model.get(), &DirectoryModel::fileAdded,    this, &DirectoryPresenter::onFileAdded);
     disconnect(model.get(), &DirectoryModel::fileRenamed,  this, &DirectoryPresenter::onFileRenamed);
+    disconnect(model.get(), &DirectoryModel::fileMoved,    this, &DirectoryPresenter::onFileMoved);
     disconnect(model.get(), &DirectoryModel::fileModified, this, &DirectoryPresenter::onFileModified);
     disconnect(model.get(), &DirectoryModel::dirRemoved,   this, &DirectoryPresenter::onDirRemoved);
     disconnect(model.get(), &DirectoryModel::dirAdded,     this, &DirectoryPresenter::onDirAdded);
     disconnect(model.get(), &DirectoryModel::dirRenamed,   this, &DirectoryPresenter::onDirRenamed);
+    disconnect(model.get(), &DirectoryModel::bulkChangeStarted, this, &DirectoryPresenter::onBulkChangeStarted);
+    disconnect(model.get(), &DirectoryModel::bulkChanged,  this, &DirectoryPresenter::onBulkChanged);
     model = nullptr;
     // also empty view?
 }
@@ -46,10 +49,13 @@ void DirectoryPresenter::setModel(std::shared_ptr<DirectoryModel> newModel) {
     connect(model.get(), &DirectoryModel::fileRemoved,  this, &DirectoryPresenter::onFileRemoved);
     connect(model.get(), &DirectoryModel::fileAdded,    this, &DirectoryPresenter::onFileAdded);
     connect(model.get(), &DirectoryModel::fileRenamed,  this, &DirectoryPresenter::onFileRenamed);
+    connect(model.get(), &DirectoryModel::fileMoved,    this, &DirectoryPresenter::onFileMoved);
     connect(model.get(), &DirectoryModel::fileModified, this, &DirectoryPresenter::onFileModified);
     connect(model.get(), &DirectoryModel::dirRemoved,   this, &DirectoryPresenter::onDirRemoved);
     connect(model.get(), &DirectoryModel::dirAdded,     this, &DirectoryPresenter::onDirAdded);
     connect(model.get(), &DirectoryModel::dirRenamed,   this, &DirectoryPresenter::onDirRenamed);
+    connect(model.get(), &DirectoryModel::bulkChangeStarted, this, &DirectoryPresenter::onBulkChangeStarted);
+    connect(model.get(), &DirectoryModel::bulkChanged,  this, &DirectoryPresenter::onBulkChanged);
 }
 
 void DirectoryPresenter::reloadModel() {
@@ -78,7 +84,11 @@ void DirectoryPresenter::onFileRemoved(QString filePath, int index) {
 
 void DirectoryPresenter::onFileRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo) {
     Q_UNUSED(fromPath)
-    Q_UNUSED(toPath)
+    onFileMoved(toPath, indexFrom, indexTo);
+}
+
+void DirectoryPresenter::onFileMoved(QString filePath, int indexFrom, int indexTo) {
+    Q_UNUSED(filePath)
     if(!view)
         return;
     if(mShowDirs) {
@@ -146,6 +156,41 @@ void DirectoryPresenter::onDirAdded(QString dirPath) {
     view->insertItem(index);
 }
 
+// remember selected paths; indexes won't be valid after the update
+void DirectoryPresenter::onBulkChangeStarted() {
+    if(!view)
+        return;
+    bulkSelection = selectedPaths();
+}
+
+// a single repopulate is way cheaper than thousands of inserts / removals
+void DirectoryPresenter::onBulkChanged(const DirectoryChanges &changes) {
+    if(!view)
+        return;
+    view->populate(mShowDirs ? model->totalCount() : model->fileCount());
+    // selected files which were renamed stay selected
+    QHash<QString, QString> renames;
+    for(auto const &rename : changes.renamedFiles)
+        renames.insert(rename.first, rename.second);
+    QList<int> selection;
+    for(auto path : bulkSelection) {
+        path = renames.value(path, path);
+        int index = model->indexOfFile(path);
+        if(index >= 0) {
+            selection << (mShowDirs ? model->dirCount() + index : index);
+        } else if(mShowDirs) {
+            index = model->indexOfDir(path);
+            if(index >= 0)
+                selection << index;
+        }
+    }
+    bulkSelection.clear();
+    if(!selection.isEmpty()) {
+        view->select(selection);
+        view->focusOn(selection.last());
+    }
+}
+
 bool DirectoryPresenter::showDirs() {
     return mShowDirs;
 }
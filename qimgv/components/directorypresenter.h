@@ -25,6 +25,7 @@ public:
 
     void onFileRemoved(QString filePath, int index);
     void onFileRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo);
+    void onFileMoved(QString filePath, int indexFrom, int indexTo);
     void onFileAdded(QString filePath);
     void onFileModified(QString filePath);
 
@@ -32,6 +33,9 @@ public:
     void onDirRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo);
     void onDirAdded(QString dirPath);
 
+    void onBulkChangeStarted();
+    void onBulkChanged(const DirectoryChanges &changes);
+
     bool showDirs();
     void setShowDirs(bool mode);
 
@@ -62,4 +66,5 @@ private:
     std::shared_ptr<DirectoryModel> model = nullptr;
     Thumbnailer thumbnailer;
     bool mShowDirs;
+    QList<QString> bulkSelection;
 };
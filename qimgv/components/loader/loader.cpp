@@ -1,4 +1,5 @@
 #include "loader.h"
+#include "utils/tracer.h"
 
 Loader::Loader() {
     pool = new QThreadPool(this);
@@ -18,26 +19,29 @@ bool Loader::isLoading(QString path) {
     return tasks.contains(path);
 }
 
-std::shared_ptr<Image> Loader::load(QString path) {
-    return ImageFactory::createImage(path);
+std::shared_ptr<Image> Loader::load(QString path, FileContents contents) {
+    TRACE_SCOPE("Loader::load", "loader");
+    return ImageFactory::createImage(path, contents);
 }
 
 // clears all buffered tasks before loading
-void Loader::loadAsyncPriority(QString path) {
+void Loader::loadAsyncPriority(QString path, FileContents contents) {
     clearPool();
-    doLoadAsync(path, 1);
+    doLoadAsync(path, contents, 1);
 }
 
-void Loader::loadAsync(QString path) {
-    doLoadAsync(path, 0);
+void Loader::loadAsync(QString path, FileContents contents) {
+    doLoadAsync(path, contents, 0);
 }
 
-void Loader::doLoadAsync(QString path, int priority) {
+void Loader::doLoadAsync(QString path, FileContents contents, int priority) {
     if(tasks.contains(path)) {
+        if(!contents.isEmpty())
+            emit contentsUnused(path, contents);
         return;
     }
 
-    auto runnable = new LoaderRunnable(path);
+    auto runnable = new LoaderRunnable(path, contents);
     runnable->setAutoDelete(false);
     tasks.insert(path, runnable);
     connect(runnable, &LoaderRunnable::finished, this, &Loader::onLoadFinished, Qt::UniqueConnection);
@@ -58,7 +62,11 @@ void Loader::clearPool() {
     while (i.hasNext()) {
         i.next();
         if(pool->tryTake(i.value())) {
-            delete tasks.take(i.key());
+            auto task = tasks.take(i.key());
+            FileContents contents = task->takeContents();
+            delete task;
+            if(!contents.isEmpty())
+                emit contentsUnused(i.key(), contents);
         }
     }
 }
@@ -8,9 +8,10 @@ class Loader : public QObject {
     Q_OBJECT
 public:
     explicit Loader();
-    std::shared_ptr<Image> load(QString path);
-    void loadAsyncPriority(QString path);
-    void loadAsync(QString path);
+    // contents: if already in memory
+    std::shared_ptr<Image> load(QString path, FileContents contents = FileContents());
+    void loadAsyncPriority(QString path, FileContents contents = FileContents());
+    void loadAsync(QString path, FileContents contents = FileContents());
 
     void clearTasks();
     bool isBusy() const;
@@ -19,11 +20,13 @@ private:
     QHash<QString, LoaderRunnable*> tasks;
     QThreadPool *pool;    
     void clearPool();
-    void doLoadAsync(QString path, int priority);
+    void doLoadAsync(QString path, FileContents contents, int priority);
 
 signals:
     void loadFinished(std::shared_ptr<Image>, const QString &path);
     void loadFailed(const QString &path);
+    // contents passed in, but not used (task dropped or already loading)
+    void contentsUnused(const QString &path, FileContents contents);
 
 private slots:
     void onLoadFinished(std::shared_ptr<Image>, const QString&);
@@ -1,14 +1,21 @@
 #include "loaderrunnable.h"
+#include "utils/tracer.h"
 
-#include <QElapsedTimer>
-
-LoaderRunnable::LoaderRunnable(QString _path) : path(_path) {
+LoaderRunnable::LoaderRunnable(QString _path, FileContents _contents) : path(_path), contents(_contents) {
 }
 
 void LoaderRunnable::run() {
-    //QElapsedTimer t;
-    //t.start();
-    auto image = ImageFactory::createImage(path);
-    //qDebug() << "L: " << t.elapsed();
+    std::shared_ptr<Image> image;
+    {
+        TRACE_SCOPE("LoaderRunnable", "loader");
+        image = ImageFactory::createImage(path, contents);
+        contents = FileContents();
+    }
     emit finished(image, path);
 }
+
+FileContents LoaderRunnable::takeContents() {
+    FileContents taken = contents;
+    contents = FileContents();
+    return taken;
+}
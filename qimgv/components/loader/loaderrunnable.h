@@ -8,10 +8,13 @@ class LoaderRunnable: public QObject, public QRunnable
 {
     Q_OBJECT
 public:
-    LoaderRunnable(QString _path);
+    LoaderRunnable(QString _path, FileContents _contents);
     void run();
+    // of a task which did not run
+    FileContents takeContents();
 private:
     QString path;
+    FileContents contents;
 signals:
     void finished(std::shared_ptr<Image>, QString);
     void failed(QString);
@@ -0,0 +1,132 @@
+#include "memorymetrics.h"
+#include "settings.h"
+#include <QCoreApplication>
+#include <QTimer>
+
+// caches may hold this many images of the maximum allowed size
+// (memoryAllocationLimit) on top of the current one
+#define CACHE_BUDGET_IMAGES 2
+
+std::atomic<qint64> MemoryMetrics::counters[MEM_CATEGORIES];
+std::atomic<qint64> MemoryMetrics::peaks[MEM_CATEGORIES];
+
+namespace {
+
+const char *categoryNames[MEM_CATEGORIES] = {
+    "image cache",
+    "read-ahead",
+    "buffer pool",
+    "viewer pixmaps",
+    "animation frames",
+    "thumbnails",
+    "thumbnail reads",
+    "file entries"
+};
+
+QString toMB(qint64 bytes) {
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+} // namespace
+
+void MemoryMetrics::add(MemoryCategory category, qint64 bytes) {
+    if(!bytes)
+        return;
+    qint64 value = counters[category].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    qint64 peak = peaks[category].load(std::memory_order_relaxed);
+    while(value > peak && !peaks[category].compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 MemoryMetrics::bytes(MemoryCategory category) {
+    return counters[category].load(std::memory_order_relaxed);
+}
+
+qint64 MemoryMetrics::peak(MemoryCategory category) {
+    return peaks[category].load(std::memory_order_relaxed);
+}
+
+qint64 MemoryMetrics::total() {
+    qint64 sum = 0;
+    for(int i = 0; i < MEM_CATEGORIES; i++)
+        sum += bytes(static_cast<MemoryCategory>(i));
+    return sum;
+}
+
+qint64 MemoryMetrics::cacheBytes() {
+    return bytes(MEM_IMAGE_CACHE) + bytes(MEM_READAHEAD) + bytes(MEM_BUFFER_POOL);
+}
+
+qint64 MemoryMetrics::cacheBudget() {
+    if(!settings) // gone at exit
+        return 0;
+    return qint64(CACHE_BUDGET_IMAGES + 1) * settings->snapshot()->memoryAllocationLimit * 1024 * 1024;
+}
+
+qint64 MemoryMetrics::cacheBudgetLeft() {
+    return cacheBudget() - cacheBytes();
+}
+
+qint64 MemoryMetrics::bytesOf(const QImage &image) {
+    return image.sizeInBytes();
+}
+
+qint64 MemoryMetrics::bytesOf(const QPixmap &pixmap) {
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+QString MemoryMetrics::report() {
+    QString out = QString("%1 %2 %3\n").arg("memory", -18).arg("current", 11).arg("peak", 11);
+    for(int i = 0; i < MEM_CATEGORIES; i++) {
+        auto category = static_cast<MemoryCategory>(i);
+        out += QString("%1 %2 %3\n").arg(categoryNames[i], -18).arg(toMB(bytes(category)), 11).arg(toMB(peak(category)), 11);
+    }
+    out += QString("%1 %2\n").arg("total", -18).arg(toMB(total()), 11);
+    out += QString("%1 %2 of %3").arg("caches", -18).arg(toMB(cacheBytes()), 11).arg(toMB(cacheBudget()));
+    return out;
+}
+
+QString MemoryMetrics::summary() {
+    QStringList parts;
+    for(int i = 0; i < MEM_CATEGORIES; i++)
+        parts << QString(categoryNames[i]) + " " + toMB(bytes(static_cast<MemoryCategory>(i)));
+    return "total " + toMB(total()) + ": " + parts.join(", ");
+}
+
+void MemoryMetrics::dump() {
+    qDebug().noquote() << "[MemoryMetrics]\n" + report();
+}
+
+void MemoryMetrics::startLog(int seconds) {
+    static QTimer *logTimer = nullptr;
+    if(!logTimer) {
+        logTimer = new QTimer(qApp);
+        QObject::connect(logTimer, &QTimer::timeout, []() {
+            qDebug().noquote() << "[MemoryMetrics]" << summary();
+        });
+    }
+    if(seconds > 0)
+        logTimer->start(seconds * 1000);
+    else
+        logTimer->stop();
+}
+
+MemoryCharge::MemoryCharge(MemoryCategory _category, qint64 bytes)
+    : category(_category),
+      mBytes(0)
+{
+    set(bytes);
+}
+
+MemoryCharge::~MemoryCharge() {
+    set(0);
+}
+
+void MemoryCharge::set(qint64 bytes) {
+    MemoryMetrics::add(category, bytes - mBytes);
+    mBytes = bytes;
+}
+
+qint64 MemoryCharge::bytes() const {
+    return mBytes;
+}
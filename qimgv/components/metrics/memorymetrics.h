@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QString>
+#include <QImage>
+#include <QPixmap>
+#include <QDebug>
+#include <atomic>
+
+enum MemoryCategory {
+    MEM_IMAGE_CACHE,      // decoded images held by Cache
+    MEM_READAHEAD,        // undecoded file contents in ReadAheadCache
+    MEM_BUFFER_POOL,      // idle pixel buffers in BufferPool
+    MEM_VIEWER_PIXMAPS,   // ImageViewerV2 pixmap & its scaled version
+    MEM_ANIMATION_FRAMES, // frames decoded by AnimationDecoder
+    MEM_THUMBNAILS,       // thumbnail pixmaps & atlas pages
+    MEM_THUMBNAIL_READS,  // thumbnail disk cache reads in flight
+    MEM_FILE_ENTRIES,     // FSEntry lists of the current directory
+    MEM_CATEGORIES
+};
+
+// Bytes held per subsystem, counted by the owners as memory is
+// allocated and freed (see MemoryCharge). Safe to use from any thread.
+//
+// Besides reporting, cache sizes are limited against these counters:
+// cacheBytes() must stay under cacheBudget().
+class MemoryMetrics {
+public:
+    static void add(MemoryCategory category, qint64 bytes);
+    static qint64 bytes(MemoryCategory category);
+    static qint64 peak(MemoryCategory category);
+    static qint64 total();
+
+    // memory kept only to speed things up:
+    // preloaded images, read-ahead files, idle buffers
+    static qint64 cacheBytes();
+    static qint64 cacheBudget();
+    // can be negative
+    static qint64 cacheBudgetLeft();
+
+    static qint64 bytesOf(const QImage &image);
+    static qint64 bytesOf(const QPixmap &pixmap);
+
+    // table with current & peak values
+    static QString report();
+    // single line
+    static QString summary();
+    static void dump();
+    // log summary() every `seconds`; 0 stops
+    static void startLog(int seconds);
+
+private:
+    static std::atomic<qint64> counters[MEM_CATEGORIES];
+    static std::atomic<qint64> peaks[MEM_CATEGORIES];
+};
+
+// Accounts some bytes to a category for as long as it exists.
+class MemoryCharge {
+public:
+    explicit MemoryCharge(MemoryCategory category, qint64 bytes = 0);
+    ~MemoryCharge();
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge &operator=(const MemoryCharge&) = delete;
+    void set(qint64 bytes);
+    qint64 bytes() const;
+
+private:
+    MemoryCategory category;
+    qint64 mBytes;
+};
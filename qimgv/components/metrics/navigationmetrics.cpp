@@ -0,0 +1,139 @@
+#include "navigationmetrics.h"
+#include <algorithm>
+#include <cmath>
+
+#define LATENCY_SAMPLES 512
+// older actions did not lead to the navigation
+#define ACTION_TIMEOUT_NS (500 * 1000000LL)
+
+NavigationMetrics *navMetrics = nullptr;
+
+void LatencySamples::add(qint64 ns) {
+    if(samples.count() < LATENCY_SAMPLES) {
+        samples.append(ns);
+    } else {
+        samples[next] = ns;
+        next = (next + 1) % LATENCY_SAMPLES;
+    }
+}
+
+int LatencySamples::count() const {
+    return samples.count();
+}
+
+qreal LatencySamples::percentile(qreal p) const {
+    if(samples.isEmpty())
+        return 0;
+    auto sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    int index = qBound(0, static_cast<int>(std::ceil(p / 100.0 * sorted.count())) - 1, sorted.count() - 1);
+    return sorted.at(index) / 1000000.0;
+}
+
+NavigationMetrics::NavigationMetrics(QObject *parent)
+    : QObject(parent),
+      actionTime(-1),
+      active(false),
+      painted(false),
+      startTime(0),
+      readyTime(-1),
+      cached(false),
+      navigations(0),
+      abandoned(0),
+      lastReady(-1)
+{
+    clock.start();
+}
+
+NavigationMetrics *NavigationMetrics::getInstance() {
+    if(!navMetrics)
+        navMetrics = new NavigationMetrics();
+    return navMetrics;
+}
+
+void NavigationMetrics::actionTriggered() {
+    actionTime = clock.nsecsElapsed();
+}
+
+void NavigationMetrics::navigationStarted(const QString &path, bool _cached) {
+    qint64 now = clock.nsecsElapsed();
+    if(active)
+        abandoned++;
+    active = true;
+    painted = false;
+    // count from the key press if there was one
+    startTime = (actionTime >= 0 && now - actionTime < ACTION_TIMEOUT_NS) ? actionTime : now;
+    actionTime = -1;
+    readyTime = -1;
+    cached = _cached;
+    format = QFileInfo(path).suffix().toLower();
+    if(format.isEmpty())
+        format = "none";
+    navigations++;
+}
+
+void NavigationMetrics::imageReady(const QString &path) {
+    Q_UNUSED(path)
+    if(active && readyTime < 0) {
+        readyTime = clock.nsecsElapsed();
+        lastReady = readyTime - startTime;
+    }
+}
+
+void NavigationMetrics::navigationSkipped() {
+    if(!active)
+        return;
+    active = false;
+    navigations--;
+}
+
+void NavigationMetrics::firstPaint(bool final) {
+    if(!active || painted)
+        return;
+    painted = true;
+    addSample(firstPaints, clock.nsecsElapsed() - startTime);
+    if(final)
+        finalPaint();
+    else
+        emit updated();
+}
+
+void NavigationMetrics::finalPaint() {
+    if(!active || !painted)
+        return;
+    active = false;
+    addSample(finalPaints, clock.nsecsElapsed() - startTime);
+    emit updated();
+}
+
+void NavigationMetrics::addSample(QMap<QString, LatencySamples> &map, qint64 ns) {
+    map["all"].add(ns);
+    map[cached ? "cache hit" : "cache miss"].add(ns);
+    map["." + format].add(ns);
+}
+
+QString NavigationMetrics::report() const {
+    QString out = QString("%1 navigations, %2 interrupted, last decode %3 ms\n")
+            .arg(navigations).arg(abandoned).arg(lastReady >= 0 ? QString::number(lastReady / 1000000.0, 'f', 1) : "-");
+    out += QString("%1 %2 %3 %4 %5\n").arg("", -20).arg("n", 5).arg("p50", 8).arg("p95", 8).arg("p99", 8);
+    auto section = [&](const QString &name, const QMap<QString, LatencySamples> &map) {
+        for(auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            out += QString("%1 %2 %3 %4 %5\n")
+                    .arg(name + " " + it.key(), -20)
+                    .arg(it.value().count(), 5)
+                    .arg(it.value().percentile(50), 8, 'f', 1)
+                    .arg(it.value().percentile(95), 8, 'f', 1)
+                    .arg(it.value().percentile(99), 8, 'f', 1);
+        }
+    };
+    section("first", firstPaints);
+    section("final", finalPaints);
+    out += "(ms from action to paint)";
+    return out;
+}
+
+void NavigationMetrics::dump() const {
+    if(!navigations)
+        return;
+    qDebug().noquote() << "[NavigationMetrics]\n" + report();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QMap>
+#include <QFileInfo>
+#include <QDebug>
+
+// Last LATENCY_SAMPLES values of one measurement.
+class LatencySamples {
+public:
+    void add(qint64 ns);
+    int count() const;
+    // p in [0, 100], in ms
+    qreal percentile(qreal p) const;
+private:
+    QVector<qint64> samples;
+    int next = 0;
+};
+
+// Time from a user action to the new image on screen.
+//
+//  - first paint: the image is painted, possibly scaled by the graphics scene
+//  - final paint: the properly scaled version is painted
+//    (same as first if no separate scaling was needed)
+//
+// Samples are kept for all navigations, split by cache hit / miss and by
+// file extension. Unfinished ones are dropped when the next one starts.
+// GUI thread only.
+class NavigationMetrics : public QObject {
+    Q_OBJECT
+public:
+    static NavigationMetrics *getInstance();
+    // the action which may lead to a navigation, e.g. a key press
+    void actionTriggered();
+    void navigationStarted(const QString &path, bool cached);
+    void imageReady(const QString &path);
+    // the file is not shown by the image viewer (videos); forget this navigation
+    void navigationSkipped();
+    // final: nothing better is coming for this image
+    void firstPaint(bool final);
+    void finalPaint();
+    QString report() const;
+    void dump() const;
+
+signals:
+    void updated();
+
+private:
+    explicit NavigationMetrics(QObject *parent = nullptr);
+    void addSample(QMap<QString, LatencySamples> &map, qint64 ns);
+
+    QElapsedTimer clock;
+    qint64 actionTime;
+    // current navigation
+    bool active, painted;
+    qint64 startTime, readyTime;
+    bool cached;
+    QString format;
+
+    QMap<QString, LatencySamples> firstPaints, finalPaints;
+    int navigations, abandoned;
+    qint64 lastReady;
+};
+
+extern NavigationMetrics *navMetrics;
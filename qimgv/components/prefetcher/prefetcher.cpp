@@ -0,0 +1,70 @@
+#include "prefetcher.h"
+
+// opened files further back than this are dropped from the page cache
+#define PREFETCH_KEEP_BEHIND 10
+
+Prefetcher::Prefetcher(QObject *parent) : QObject(parent) {
+    pool = new QThreadPool(this);
+    pool->setMaxThreadCount(1);
+    runnable = new PrefetcherRunnable(&state);
+    runnable->setAutoDelete(false);
+    connect(runnable, &PrefetcherRunnable::batchFinished, this, &Prefetcher::statsChanged);
+    pool->start(runnable);
+}
+
+Prefetcher::~Prefetcher() {
+    state.mutex.lock();
+    state.stop = true;
+    state.wake.wakeAll();
+    state.mutex.unlock();
+    pool->waitForDone();
+    delete runnable;
+}
+
+void Prefetcher::setWindow(const QString &current, const QStringList &upcoming) {
+    QMutexLocker lock(&state.mutex);
+    // not fetched yet, will be re-queued if still needed
+    for(auto const &path : state.queue)
+        fetched.remove(path);
+    state.queue.clear();
+    for(auto const &path : upcoming) {
+        if(!fetched.contains(path) && path != current) {
+            fetched.insert(path);
+            state.queue.append(path);
+        }
+    }
+    if(history.empty() || history.back() != current)
+        history.push_back(current);
+    while(history.size() > PREFETCH_KEEP_BEHIND) {
+        QString path = history.front();
+        history.pop_front();
+        if(path != current && !upcoming.contains(path) && std::find(history.begin(), history.end(), path) == history.end()) {
+            fetched.remove(path);
+            state.evict.append(path);
+        }
+    }
+    state.wake.wakeAll();
+}
+
+void Prefetcher::clear() {
+    QMutexLocker lock(&state.mutex);
+    state.queue.clear();
+    fetched.clear();
+    history.clear();
+}
+
+void Prefetcher::pause() {
+    QMutexLocker lock(&state.mutex);
+    state.paused = true;
+}
+
+void Prefetcher::resume() {
+    QMutexLocker lock(&state.mutex);
+    state.paused = false;
+    state.wake.wakeAll();
+}
+
+PrefetchStats Prefetcher::stats() {
+    QMutexLocker lock(&state.mutex);
+    return state.stats;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QSet>
+#include <deque>
+#include <algorithm>
+#include "prefetcherrunnable.h"
+
+// Asks the os to read upcoming files into the page cache,
+// so the loader does not wait on slow disks or network mounts.
+//
+// Files are fetched one at a time, nearest first, and only while
+// nothing is being decoded. Files which fall far behind the
+// current one are dropped from the page cache again.
+class Prefetcher : public QObject {
+    Q_OBJECT
+public:
+    explicit Prefetcher(QObject *parent = nullptr);
+    ~Prefetcher();
+    // upcoming: files likely to be opened next, nearest first
+    void setWindow(const QString &current, const QStringList &upcoming);
+    void clear();
+    // hold off while the loader is busy
+    void pause();
+    void resume();
+    PrefetchStats stats();
+
+signals:
+    void statsChanged();
+
+private:
+    QThreadPool *pool;
+    PrefetcherRunnable *runnable;
+    PrefetcherState state;
+    QSet<QString> fetched;
+    std::deque<QString> history; // recently opened, oldest first
+};
@@ -0,0 +1,96 @@
+#include "prefetcherrunnable.h"
+#include <QElapsedTimer>
+#include <QFile>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <climits>
+#endif
+
+PrefetcherRunnable::PrefetcherRunnable(PrefetcherState *_state) : state(_state) {
+}
+
+void PrefetcherRunnable::run() {
+    QMutexLocker lock(&state->mutex);
+    PrefetchStats batch;
+    while(!state->stop) {
+        if(!state->evict.isEmpty()) {
+            QString path = state->evict.takeFirst();
+            lock.unlock();
+            drop(path);
+            lock.relock();
+            continue;
+        }
+        if(state->paused || state->queue.isEmpty()) {
+            if(batch.files) {
+                qDebug() << "[Prefetcher]" << batch.files << "files," << batch.bytes / 1048576 << "MB at" << batch.mbPerSecond() << "MB/s";
+                batch = PrefetchStats();
+                emit batchFinished();
+            }
+            state->wake.wait(&state->mutex);
+            continue;
+        }
+        QString path = state->queue.takeFirst();
+        lock.unlock();
+        QElapsedTimer t;
+        t.start();
+        qint64 bytes = fetch(path);
+        qint64 elapsed = t.nsecsElapsed();
+        lock.relock();
+        if(bytes > 0) {
+            state->stats.files++;
+            state->stats.bytes += bytes;
+            state->stats.elapsedNs += elapsed;
+            batch.files++;
+            batch.bytes += bytes;
+            batch.elapsedNs += elapsed;
+        }
+    }
+}
+
+// Pulls the file into the page cache; returns its size.
+// On linux this blocks until the data is read, which keeps
+// a single file in flight and makes the timing meaningful.
+// macOS has no posix_fadvise, F_RDADVISE is the equivalent.
+qint64 PrefetcherRunnable::fetch(const QString &path) {
+#ifdef Q_OS_UNIX
+    int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY);
+    if(fd == -1)
+        return 0;
+    struct stat st;
+    qint64 size = 0;
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        size = st.st_size;
+#if defined(Q_OS_LINUX)
+        if(readahead(fd, 0, static_cast<size_t>(size)) != 0)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#elif defined(Q_OS_FREEBSD)
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#elif defined(Q_OS_MACOS)
+        struct radvisory ra;
+        ra.ra_offset = 0;
+        ra.ra_count = static_cast<int>(qMin<qint64>(size, INT_MAX));
+        fcntl(fd, F_RDADVISE, &ra);
+#endif
+    }
+    ::close(fd);
+    return size;
+#else
+    Q_UNUSED(path)
+    return 0;
+#endif
+}
+
+// no-op where posix_fadvise is missing
+void PrefetcherRunnable::drop(const QString &path) {
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+    int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY);
+    if(fd == -1)
+        return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    Q_UNUSED(path)
+#endif
+}
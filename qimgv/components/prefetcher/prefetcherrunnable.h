@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QDebug>
+
+struct PrefetchStats {
+    int files = 0;
+    qint64 bytes = 0;
+    qint64 elapsedNs = 0;
+
+    double mbPerSecond() const {
+        return elapsedNs ? (bytes / 1048576.0) / (elapsedNs / 1e9) : 0.0;
+    }
+};
+
+// Shared between Prefetcher (gui thread) and the worker.
+// Everything is guarded by the mutex.
+struct PrefetcherState {
+    QMutex mutex;
+    QWaitCondition wake;
+    bool stop = false;
+    bool paused = false;  // a decode is running
+    QStringList queue;    // files to read ahead, nearest first
+    QStringList evict;    // files to drop from the page cache
+    PrefetchStats stats;
+};
+
+class PrefetcherRunnable : public QObject, public QRunnable {
+    Q_OBJECT
+public:
+    PrefetcherRunnable(PrefetcherState *_state);
+    void run();
+
+signals:
+    // stats were updated; the worker is idle
+    void batchFinished();
+
+private:
+    PrefetcherState *state;
+    static qint64 fetch(const QString &path);
+    static void drop(const QString &path);
+};
@@ -8,12 +8,11 @@
  *    start the last task that came and ignore the middle ones.
  */
 
-Scaler::Scaler(Cache *_cache, QObject *parent)
+Scaler::Scaler(QObject *parent)
     : QObject(parent),
       buffered(false),
       running(false),
-      currentRequestTimestamp(0),
-      cache(_cache)
+      currentRequestTimestamp(0)
 {
     sem = new QSemaphore(1);
     pool = new QThreadPool(this);
@@ -26,55 +25,15 @@ Scaler::Scaler(Cache *_cache, QObject *parent)
     connect(this, &Scaler::acceptScalingResult, this, &Scaler::slotForwardScaledResult, Qt::QueuedConnection);
 }
 
+// Requests keep their image alive through the shared_ptr,
+// so there is nothing to reserve in the cache.
 void Scaler::requestScaled(ScalerRequest req) {
     sem->acquire(1);
-    if(!running) {
-//////////////////////////////////
-        if(!buffered) {
-            bufferedRequest = req;
-            buffered = true;
-          //qDebug() << "1 requestScaled() - locking..  " <<  req.image->name();
-            cache->reserve(req.image->fileName());
-          //qDebug() << "1 requestScaled() - LOCKED!  " <<  req.image->name();
-            startRequest(req);
-        } else if(bufferedRequest.image != req.image) {
-          //qDebug() << "2 requestScaled() - locking...  " <<  req.image->name();
-            cache->reserve(req.image->fileName());
-          //qDebug() << "2 requestScaled() - LOCKED!  " <<  req.image->name();
-            auto tmp = bufferedRequest;
-            bufferedRequest = req;
-            buffered = true;
-            if(startedRequest.image != tmp.image) {
-                cache->release(tmp.image->fileName());
-              //qDebug() << "2 requestScaled() - RELEASED!  " <<  tmp.image->name();
-            }
-        } else {
-            bufferedRequest = req;
-            buffered = true;
-        }
-//////////////////////////////
-    } else {
-        if(!buffered) {
-            if(req.image != startedRequest.image)
-                cache->reserve(req.image->fileName());
-            bufferedRequest = req;
-            buffered = true;
-        } else {
-            if(req.image == bufferedRequest.image) {
-                bufferedRequest = req;
-                buffered = true;
-            } else {
-                if(bufferedRequest.image != startedRequest.image) {
-                    //qDebug() << "4 RELEASING " << bufferedRequest.image->name();
-                    cache->release(bufferedRequest.image->fileName());
-                }
-                if(req.image != startedRequest.image)
-                    cache->reserve(req.image->fileName());
-                bufferedRequest = req;
-                buffered = true;
-            }
-        }
-    }
+    bool idle = !running && !buffered;
+    bufferedRequest = req;
+    buffered = true;
+    if(idle)
+        startRequest(req);
     sem->release(1);
 }
 
@@ -93,13 +52,6 @@ void Scaler::onTaskStart(ScalerRequest req) {
 void Scaler::onTaskFinish(QImage *scaled, ScalerRequest req) {
     sem->acquire(1);
     running = false;
-    if(buffered && bufferedRequest.image == req.image) {
-    } else {
-      //qDebug() << "onTaskFinish() - 2 releasing..  " <<  req.image->name();
-        QString name = req.image->fileName();
-        cache->release(req.image->fileName());
-      //qDebug() << "onTaskFinish() - 2 RELEASED!  " <<  name;
-    }
     if(buffered) {
       //qDebug() << "onTaskFinish - startingBuffered: " << bufferedRequest.string;
         delete scaled;
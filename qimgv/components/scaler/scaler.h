@@ -4,14 +4,14 @@
 #include <QThreadPool>
 #include <QThread>
 #include <QMutex>
-#include "components/cache/cache.h"
+#include <QSemaphore>
 #include "scalerrequest.h"
 #include "scalerrunnable.h"
 
 class Scaler : public QObject {
     Q_OBJECT
 public:
-    explicit Scaler(Cache *_cache, QObject *parent = nullptr);
+    explicit Scaler(QObject *parent = nullptr);
 
 signals:
     void scalingFinished(QPixmap* result, ScalerRequest request);
@@ -34,8 +34,6 @@ private:
     clock_t currentRequestTimestamp;
     ScalerRequest bufferedRequest, startedRequest;
 
-    Cache *cache;
-
     void startRequest(ScalerRequest req);
 
     QSemaphore *sem;
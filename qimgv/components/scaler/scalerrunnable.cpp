@@ -1,6 +1,5 @@
 #include "scalerrunnable.h"
-
-#include <QElapsedTimer>
+#include "utils/tracer.h"
 
 ScalerRunnable::ScalerRunnable() {
 }
@@ -11,14 +10,12 @@ void ScalerRunnable::setRequest(ScalerRequest r) {
 
 void ScalerRunnable::run() {
     emit started(req);
-    //QElapsedTimer t;
-    //t.start();
     QImage *scaled = nullptr;
-    if(req.filter == 0 || (req.size.width() > req.image->width() && !settings->smoothUpscaling())) {
+    TRACE_SCOPE("ScalerRunnable", "scaler");
+    if(req.filter == 0 || (req.size.width() > req.image->width() && !settings->snapshot()->smoothUpscaling)) {
         scaled = ImageLib::scaled(req.image->getImage(), req.size, QI_FILTER_NEAREST);
     } else {
         scaled = ImageLib::scaled(req.image->getImage(), req.size, req.filter);
     }
-    //qDebug() << ">> " << req.size << ": " << t.elapsed();
     emit finished(scaled, req);
 }
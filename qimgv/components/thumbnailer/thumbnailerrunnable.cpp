@@ -1,4 +1,5 @@
 #include "thumbnailerrunnable.h"
+#include "utils/tracer.h"
 
 ThumbnailerRunnable::ThumbnailerRunnable(ThumbnailCache* _cache, QString _path, int _size, bool _crop, bool _force) :
     path(_path),
@@ -24,6 +25,7 @@ QString ThumbnailerRunnable::generateIdString(QString path, int size, bool crop)
 }
 
 std::shared_ptr<Thumbnail> ThumbnailerRunnable::generate(ThumbnailCache* cache, QString path, int size, bool crop, bool force) {
+    TRACE_SCOPE("ThumbnailerRunnable::generate", "thumbnailer");
     DocumentInfo imgInfo(path);
     QString thumbnailId = generateIdString(path, size, crop);
     std::unique_ptr<QImage> image;
@@ -45,7 +47,7 @@ std::shared_ptr<Thumbnail> ThumbnailerRunnable::generate(ThumbnailCache* cache,
         if(imgInfo.type() == VIDEO)
             pair = createVideoThumbnail(path, size, crop);
         else
-            pair = createThumbnail(imgInfo.filePath(), imgInfo.format().toStdString().c_str(), size, crop);
+            pair = createThumbnail(imgInfo.device(), imgInfo.format().toStdString().c_str(), size, crop);
         image.reset(pair.first);
         QSize originalSize = pair.second;
 
@@ -90,8 +92,8 @@ std::shared_ptr<Thumbnail> ThumbnailerRunnable::generate(ThumbnailCache* cache,
 ThumbnailerRunnable::~ThumbnailerRunnable() {
 }
 
-std::pair<QImage*, QSize> ThumbnailerRunnable::createThumbnail(QString path, const char *format, int size, bool squared) {
-    QImageReader *reader = new QImageReader(path, format);
+std::pair<QImage*, QSize> ThumbnailerRunnable::createThumbnail(QIODevice *device, const char *format, int size, bool squared) {
+    QImageReader *reader = new QImageReader(device, format);
     Qt::AspectRatioMode ARMode = squared?
                 (Qt::KeepAspectRatioByExpanding):(Qt::KeepAspectRatio);
     QImage *result = nullptr;
@@ -118,9 +120,11 @@ std::pair<QImage*, QSize> ThumbnailerRunnable::createThumbnail(QString path, con
             result = nullptr;
             // Force reset reader because it is really finicky
             // and can fail on the second read attempt (yeah wtf)
-            reader->setFileName("");
+            reader->setDevice(nullptr);
             delete reader;
-            reader = new QImageReader(path, format);
+            if(device)
+                device->seek(0);
+            reader = new QImageReader(device, format);
         }
     }
     if(manualResize) { // manual resize & crop. slower but should just work
@@ -147,8 +151,8 @@ std::pair<QImage*, QSize> ThumbnailerRunnable::createThumbnail(QString path, con
         }
         delete fullSize;
     }
-    // force reader to close file so it can be deleted later
-    reader->setFileName("");
+    // the file itself is closed along with DocumentInfo
+    reader->setDevice(nullptr);
     delete reader;
     return std::make_pair(result, originalSize);
 }
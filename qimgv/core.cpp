@@ -11,6 +11,10 @@
 #include <tchar.h>
 #endif
 
+// files ahead of the current one handed to the os for read-ahead;
+// the nearest of them are also kept in memory
+#define READAHEAD_DEPTH 60
+
 Core::Core()
     : QObject(),
       folderEndAction(FOLDER_END_NO_ACTION),
@@ -123,11 +127,13 @@ void Core::connectComponents() {
     connect(model.get(), &DirectoryModel::fileRemoved,    this, &Core::onFileRemoved);
     connect(model.get(), &DirectoryModel::fileRenamed,    this, &Core::onFileRenamed);
     connect(model.get(), &DirectoryModel::fileModified,   this, &Core::onFileModified);
+    connect(model.get(), &DirectoryModel::bulkChanged,    this, &Core::onBulkChanged);
     connect(model.get(), &DirectoryModel::loaded,         this, &Core::onModelLoaded);
     connect(model.get(), &DirectoryModel::imageReady,     this, &Core::onModelItemReady);
     connect(model.get(), &DirectoryModel::imageUpdated,   this, &Core::onModelItemUpdated);
     connect(model.get(), &DirectoryModel::sortingChanged, this, &Core::onModelSortingChanged);
     connect(model.get(), &DirectoryModel::loadFailed,     this, &Core::onLoadFailed);
+    connect(model.get(), &DirectoryModel::prefetchStatsChanged, this, &Core::onPrefetchStatsChanged);
 
     connect(&slideshowTimer, &QTimer::timeout, this, &Core::nextImageSlideshow);
 }
@@ -202,6 +208,7 @@ void Core::initActions() {
     connect(actionManager, &ActionManager::print, this, &Core::print);
     connect(actionManager, &ActionManager::toggleFullscreenInfoBar, this, &Core::toggleFullscreenInfoBar);
     connect(actionManager, &ActionManager::pasteFile, this, &Core::openFromClipboard);
+    connect(actionManager, &ActionManager::toggleMetricsOverlay, mw, &MW::toggleMetricsOverlay);
 }
 
 void Core::loadTranslation() {
@@ -244,6 +251,7 @@ void Core::onUpdate() {
 #ifdef USE_OPENCV
     if(lastVer < QVersionNumber(0,9,0))
         settings->setScalingFilter(QI_FILTER_CV_CUBIC);
+    settings->updateSnapshot();
 #endif
 
     actionManager->adjustFromVersion(lastVer);
@@ -681,8 +689,8 @@ void Core::onFileRemoved(QString filePath, int index) {
     // image mode && removed current file
     if(state.currentFilePath == filePath) {
         if(mw->currentViewMode() == MODE_DOCUMENT) {
-            if(!loadFileIndex(index, true, settings->usePreloader()))
-                loadFileIndex(--index, true, settings->usePreloader());
+            if(!loadFileIndex(index, true, settings->snapshot()->usePreloader))
+                loadFileIndex(--index, true, settings->snapshot()->usePreloader);
         } else {
             state.hasActiveImage = false;
             state.currentFilePath = "";
@@ -693,7 +701,7 @@ void Core::onFileRemoved(QString filePath, int index) {
 
 void Core::onFileRenamed(QString fromPath, int /*indexFrom*/, QString /*toPath*/, int indexTo) {
     if(state.currentFilePath == fromPath) {
-        loadFileIndex(indexTo, true, settings->usePreloader());
+        loadFileIndex(indexTo, true, settings->snapshot()->usePreloader);
     }
 }
 
@@ -702,7 +710,7 @@ void Core::onFileAdded(QString filePath) {
     // update file count
     updateInfoString();
     if(model->fileCount() == 1 && state.currentFilePath == "")
-        loadFileIndex(0, false, settings->usePreloader());
+        loadFileIndex(0, false, settings->snapshot()->usePreloader);
 }
 
 // !! fixme
@@ -710,6 +718,38 @@ void Core::onFileModified(QString filePath) {
     Q_UNUSED(filePath)
 }
 
+void Core::onBulkChanged(const DirectoryChanges &changes) {
+    // no files left
+    if(model->isEmpty()) {
+        mw->closeImage();
+        state.hasActiveImage = false;
+        state.currentFilePath = "";
+    }
+    auto renamed = std::find_if(changes.renamedFiles.begin(), changes.renamedFiles.end(),
+                                [this](const QPair<QString, QString> &rename) { return rename.first == state.currentFilePath; });
+    int removedIndex = changes.removedFiles.indexOf(state.currentFilePath);
+    if(!state.currentFilePath.isEmpty() && renamed != changes.renamedFiles.end()) {
+        // follow the file, same as onFileRenamed()
+        loadFileIndex(model->indexOfFile(renamed->second), true, settings->snapshot()->usePreloader);
+    } else if(!state.currentFilePath.isEmpty() && removedIndex != -1) {
+        if(mw->currentViewMode() == MODE_DOCUMENT) {
+            int index = qMin(changes.removedFileIndexes.at(removedIndex), model->fileCount() - 1);
+            loadFileIndex(index, true, settings->snapshot()->usePreloader);
+        } else {
+            state.hasActiveImage = false;
+            state.currentFilePath = "";
+        }
+    } else if(state.currentFilePath.isEmpty() && model->fileCount() && model->fileCount() == changes.addedFiles.count()) {
+        // directory was empty before
+        loadFileIndex(0, false, settings->snapshot()->usePreloader);
+    }
+    updateInfoString();
+}
+
+void Core::onPrefetchStatsChanged() {
+    mw->setPrefetchStats(model->prefetchStats());
+}
+
 void Core::outputError(const FileOpResult &error) const {
     if(error == FileOpResult::SUCCESS || error == FileOpResult::NOTHING_TO_DO)
         return;
@@ -1246,7 +1286,7 @@ bool Core::loadPath(QString path) {
             }
         }
         mw->enableDocumentView();
-        return loadFileIndex(index, false, settings->usePreloader());
+        return loadFileIndex(index, false, settings->snapshot()->usePreloader);
     } else {
         mw->enableFolderView();
         return true;
@@ -1271,19 +1311,38 @@ bool Core::loadFileIndex(int index, bool async, bool preload) {
     auto entry = model->fileEntryAt(index);
     if(entry.path.isEmpty())
         return false;
+    bool forward = (index >= model->indexOfFile(state.currentFilePath));
     state.currentFilePath = entry.path;
     model->unloadExcept(entry.path, preload);
+    navMetrics->navigationStarted(entry.path, model->isLoaded(entry.path));
     model->load(entry.path, async);
     if(preload) {
         model->preload(model->nextOf(entry.path));
         model->preload(model->prevOf(entry.path));
     }
+    // preload is off in shuffle mode, but the shuffle order is known
+    if(settings->snapshot()->usePreloader)
+        model->readAhead(entry.path, upcomingFiles(index, forward));
     thumbPanelPresenter.selectAndFocus(entry.path);
     folderViewPresenter.selectAndFocus(entry.path);
     updateInfoString();
     return true;
 }
 
+// files likely to be opened after this one, nearest first
+QStringList Core::upcomingFiles(int index, bool forward) {
+    QStringList paths;
+    if(shuffle) {
+        for(int i : randomizer.upcoming(READAHEAD_DEPTH))
+            paths << model->filePathAt(i);
+        return paths;
+    }
+    int step = forward ? 1 : -1;
+    for(int i = index + step; i >= 0 && i < model->fileCount() && paths.count() < READAHEAD_DEPTH; i += step)
+        paths << model->filePathAt(i);
+    return paths;
+}
+
 void Core::loadParentDir() {
     if(model->directoryPath().isEmpty() || mw->currentViewMode() != MODE_FOLDERVIEW)
         return;
@@ -1370,7 +1429,7 @@ void Core::nextImage() {
             return;
         }
     }
-    loadFileIndex(newIndex, true, settings->usePreloader());
+    loadFileIndex(newIndex, true, settings->snapshot()->usePreloader);
 }
 
 void Core::prevImage() {
@@ -1395,7 +1454,7 @@ void Core::prevImage() {
             return;
         }
     }
-    loadFileIndex(newIndex, true, settings->usePreloader());
+    loadFileIndex(newIndex, true, settings->snapshot()->usePreloader);
 }
 
 void Core::nextImageSlideshow() {
@@ -1436,7 +1495,7 @@ void Core::jumpToFirst() {
     if(model->isEmpty())
         return;
     stopSlideshow();
-    loadFileIndex(0, true, settings->usePreloader());
+    loadFileIndex(0, true, settings->snapshot()->usePreloader);
     mw->showMessageDirectoryStart();
 }
 
@@ -1444,7 +1503,7 @@ void Core::jumpToLast() {
     if(model->isEmpty())
         return;
     stopSlideshow();
-    loadFileIndex(model->fileCount() - 1, true, settings->usePreloader());
+    loadFileIndex(model->fileCount() - 1, true, settings->snapshot()->usePreloader);
     mw->showMessageDirectoryEnd();
 }
 
@@ -1456,6 +1515,10 @@ void Core::onLoadFailed(const QString &path) {
 
 void Core::onModelItemReady(std::shared_ptr<Image> img, const QString &path) {
     if(path == state.currentFilePath) {
+        if(img && img->type() == VIDEO)
+            navMetrics->navigationSkipped();
+        else
+            navMetrics->imageReady(path);
         state.currentImg = img;
         guiSetImage(img);
         updateInfoString();
@@ -1464,7 +1527,7 @@ void Core::onModelItemReady(std::shared_ptr<Image> img, const QString &path) {
             state.delayModel = false;
             QTimer::singleShot(40, this, SLOT(modelDelayLoad()));
         }
-        model->unloadExcept(state.currentFilePath, settings->usePreloader());
+        model->unloadExcept(state.currentFilePath, settings->snapshot()->usePreloader);
     }
 }
 
@@ -77,6 +77,7 @@ private:
 
     Randomizer randomizer;
     void syncRandomizer();
+    QStringList upcomingFiles(int index, bool forward);
 
     void attachModel(DirectoryModel *_model);
     QString selectedPath();
@@ -126,6 +127,8 @@ private slots:
     void onFileRenamed(QString fromPath, int indexFrom, QString toPath, int indexTo);
     void onFileAdded(QString filePath);
     void onFileModified(QString filePath);
+    void onBulkChanged(const DirectoryChanges &changes);
+    void onPrefetchStatsChanged();
     void showResizeDialog();
     void resize(QSize size);
     void flipH();
@@ -1,4 +1,5 @@
 #include "thumbnailview.h"
+#include "utils/tracer.h"
 
 ThumbnailView::ThumbnailView(Qt::Orientation _orientation, QWidget *parent)
     : QGraphicsView(parent),
@@ -8,14 +9,14 @@ ThumbnailView::ThumbnailView(Qt::Orientation _orientation, QWidget *parent)
       mDrawScrollbarIndicator(true),
       mThumbnailSize(120),
       rangeSelection(false),
-      selectMode(ACTIVATE_BY_PRESS),
-      lastScrollFrameTime(0),
-      scrollTimeLine(nullptr)
+      selectMode(ACTIVATE_BY_PRESS)
 {
     setAccessibleName("thumbnailView");
     this->setMouseTracking(true);
     this->setAcceptDrops(false);
     this->setScene(&scene);
+    // widgets get moved around all the time; there are too few for an index to help
+    scene.setItemIndexMethod(QGraphicsScene::NoIndex);
     setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
     setAttribute(Qt::WA_TranslucentBackground, false);
     this->setOptimizationFlag(QGraphicsView::DontAdjustForAntialiasing, true);
@@ -35,18 +36,27 @@ ThumbnailView::ThumbnailView(Qt::Orientation _orientation, QWidget *parent)
     for(auto screen : qApp->screens())
         if(screen->refreshRate() > screenMaxRefreshRate)
             screenMaxRefreshRate = screen->refreshRate();
-    scrollRefreshRate = 1000 / screenMaxRefreshRate;
-
-    createScrollTimeLine();
+    scrollDriver.setRefreshRate(screenMaxRefreshRate);
+    connect(&scrollDriver, &ScrollDriver::valueChanged, [this](int value) {
+        this->centerOn(value);
+    });
+    connect(&scrollDriver, &ScrollDriver::idle, this, &ThumbnailView::onScrollIdle);
+    connect(&scrollDriver, &ScrollDriver::finished, [this]() {
+        blockThumbnailLoading = false;
+        applyPendingThumbnails(false);
+        loadVisibleThumbnails();
+    });
 
     horizontalScrollBar()->setContextMenuPolicy(Qt::NoContextMenu);
     horizontalScrollBar()->installEventFilter(this);
     connect(horizontalScrollBar(), &QScrollBar::valueChanged, [this]() {
+        updateVisibleWidgets();
         loadVisibleThumbnails();
     });
     verticalScrollBar()->setContextMenuPolicy(Qt::NoContextMenu);
     verticalScrollBar()->installEventFilter(this);
     connect(verticalScrollBar(), &QScrollBar::valueChanged, [this]() {
+        updateVisibleWidgets();
         loadVisibleThumbnails();
     });
 }
@@ -80,33 +90,28 @@ void ThumbnailView::hideEvent(QHideEvent *event) {
     rangeSelection = false;
 }
 
-void ThumbnailView::createScrollTimeLine() {
-    if(scrollTimeLine) {
-        scrollTimeLine->stop();
-        scrollTimeLine->deleteLater();
-    }
-    scrollTimeLine = new QTimeLine(SCROLL_DURATION, this);
-    scrollTimeLine->setEasingCurve(QEasingCurve::OutSine);
-    scrollTimeLine->setUpdateInterval(scrollRefreshRate);
+// spread over the animation frames, in whatever time the frame has left
+void ThumbnailView::onScrollIdle() {
+    applyPendingThumbnails(true);
+    if(scrollDriver.budgetLeftNs() > 0 && (!lastLoadPass.isValid() || lastLoadPass.elapsed() >= LOAD_DELAY))
+        requestThumbnails();
+}
 
-    connect(scrollTimeLine, &QTimeLine::frameChanged, [this](int value) {
-        scrollFrameTimer.start();
-        this->centerOn(value);
-        // trigger repaint immediately
-        qApp->processEvents();
-        lastScrollFrameTime = scrollFrameTimer.elapsed();
-        if(scrollTimeLine->state() == QTimeLine::Running && lastScrollFrameTime > scrollRefreshRate) {
-            scrollTimeLine->setPaused(true);
-            int newTime = qMin(scrollTimeLine->duration(), scrollTimeLine->currentTime() + lastScrollFrameTime);
-            scrollTimeLine->setCurrentTime(newTime);
-            scrollTimeLine->setPaused(false);
-        }
-    });
+void ThumbnailView::applyPendingThumbnails(bool withinBudget) {
+    while(!pendingWidgets.isEmpty() && (!withinBudget || scrollDriver.budgetLeftNs() > 0)) {
+        auto widget = pendingWidgets.takeFirst();
+        // recycled ones are already up to date
+        if(widget->index >= 0 && thumbs.at(widget->index))
+            widget->setThumbnail(thumbs.at(widget->index));
+    }
+}
 
-    connect(scrollTimeLine, &QTimeLine::finished, [this]() {
-        blockThumbnailLoading = false;
-        loadVisibleThumbnails();
-    });
+void ThumbnailView::stopScrolling() {
+    if(!scrollDriver.isRunning())
+        return;
+    scrollDriver.stop();
+    blockThumbnailLoading = false;
+    applyPendingThumbnails(false);
 }
 
 bool ThumbnailView::eventFilter(QObject *o, QEvent *ev) {
@@ -131,19 +136,20 @@ void ThumbnailView::setDirectoryPath(QString path) {
 }
 
 void ThumbnailView::select(QList<int> indices) {
-    for(auto i : mSelection)
-        thumbnails.at(i)->setHighlighted(false);
     QList<int>::iterator it = indices.begin();
     while(it != indices.end()) {
         // sanity check
-        if(*it < 0 || *it >= itemCount()) {
+        if(*it < 0 || *it >= itemCount())
             it = indices.erase(it);
-        } else {
-            thumbnails.at(*it)->setHighlighted(true);
+        else
             ++it;
-        }
     }
     mSelection = indices;
+    mSelectionSet.clear();
+    for(auto i : mSelection)
+        mSelectionSet.insert(i);
+    for(auto it = widgets.begin(); it != widgets.end(); ++it)
+        it.value()->setHighlighted(isSelected(it.key()));
     updateScrollbarIndicator();
 }
 
@@ -159,27 +165,29 @@ void ThumbnailView::deselect(int index) {
             return;
     if(mSelection.count() > 1) {
         mSelection.removeAll(index);
-        thumbnails.at(index)->setHighlighted(false);
+        mSelectionSet.remove(index);
+        if(widgets.contains(index))
+            widgets.value(index)->setHighlighted(false);
     }
 }
 
 void ThumbnailView::addSelectionRange(int indexTo) {
     if(!rangeSelectionSnapshot.count() || !selection().count())
         return;
-    auto list = rangeSelectionSnapshot;
-    if(indexTo > rangeSelectionSnapshot.last()) {
-        for(int i = rangeSelectionSnapshot.last() + 1; i <= indexTo; i++) {
-            if(list.contains(i))
-                list.removeAll(i);
-            list << i;
-        }
-    } else {
-        for(int i = rangeSelectionSnapshot.last() - 1; i >= indexTo; i--) {
-            if(list.contains(i))
-                list.removeAll(i);
-            list << i;
-        }
+    // the range goes to the end, in order, starting next to the last selected
+    int from = rangeSelectionSnapshot.last();
+    if(indexTo == from) {
+        select(rangeSelectionSnapshot);
+        return;
     }
+    int step = (indexTo > from) ? 1 : -1;
+    int low = qMin(from + step, indexTo), high = qMax(from + step, indexTo);
+    QList<int> list;
+    for(auto i : rangeSelectionSnapshot)
+        if(i < low || i > high)
+            list << i;
+    for(int i = from + step; i != indexTo + step; i += step)
+        list << i;
     select(list);
 }
 
@@ -188,9 +196,10 @@ QList<int> ThumbnailView::selection() {
 }
 
 void ThumbnailView::clearSelection() {
-    for(auto i : mSelection)
-        thumbnails.at(i)->setHighlighted(false);
+    for(auto widget : widgets)
+        widget->setHighlighted(false);
     mSelection.clear();
+    mSelectionSet.clear();
 }
 
 int ThumbnailView::lastSelected() {
@@ -201,7 +210,7 @@ int ThumbnailView::lastSelected() {
 }
 
 int ThumbnailView::itemCount() {
-    return thumbnails.count();
+    return thumbs.count();
 }
 
 void ThumbnailView::show() {
@@ -219,81 +228,47 @@ void ThumbnailView::showEvent(QShowEvent *event) {
 }
 
 void ThumbnailView::populate(int newCount) {
-    // wait for possible queued layout events before removing items
-    qApp->processEvents();
-
+    TRACE_SCOPE("ThumbnailView::populate", "gui");
     clearSelection();
     // reset
     lastScrollDirection = SCROLL_FORWARDS;
     // pause updates until the layout is calculated
     // without this you will see scene moving when scrollbar appears
     this->setUpdatesEnabled(false);
-    QElapsedTimer t;
-    t.start();
-    if(newCount >= 0) {
-        /* test this later
-        // reuse existing items
-        auto currentCount = thumbnails.count();
-        if(currentCount > newCount) {
-            qDebug() << this << "removing";
-            for(auto i = currentCount - 1; i >= newCount; i--) {
-                //removeItemFromLayout(i); // slow. is this needed?
-                delete thumbnails.takeLast();
-            }
-            // reset existing
-            QList<ThumbnailWidget*>::iterator i;
-            for(i = thumbnails.begin(); i != thumbnails.end(); ++i)
-                (*i)->reset();
-        } else if(currentCount <= newCount) {
-            // reset existing
-            QList<ThumbnailWidget*>::iterator i;
-            for(i = thumbnails.begin(); i != thumbnails.end(); ++i)
-                (*i)->reset();
-            qDebug() << this << "adding";
-            for(auto i = currentCount; i < newCount; i++) {
-                ThumbnailWidget *widget = createThumbnailWidget();
-                widget->setThumbnailSize(mThumbnailSize);
-                thumbnails.append(widget);
-                addItemToLayout(widget, i);
-            }
-        }
-        */
-
-        if(newCount == thumbnails.count()) {
-            QList<ThumbnailWidget*>::iterator i;
-            for (i = thumbnails.begin(); i != thumbnails.end(); ++i) {
-                (*i)->reset();
-            }
-        } else {
-            removeAll();
-            for(int i = 0; i < newCount; i++) {
-                ThumbnailWidget *widget = createThumbnailWidget();
-                widget->setThumbnailSize(mThumbnailSize);
-                thumbnails.append(widget);
-                addItemToLayout(widget, i);
-            }
-        }
-    }
+    for(auto widget : widgets)
+        releaseWidget(widget);
+    widgets.clear();
+    pendingWidgets.clear();
+    mDropHovered = -1;
+    thumbs.clear();
+    loadedSet.clear();
+    atlas.trim();
+    preloadFirst = 0;
+    preloadLast = -1;
+    if(newCount >= 0)
+        thumbs.resize(newCount);
     updateLayout();
     fitSceneToContents();
     resetViewport();
-    //qDebug() << "_______POPULATE" << this << t.elapsed();
-    // wait for layout before updating
-    qApp->processEvents();
+    updateVisibleWidgets();
     this->setUpdatesEnabled(true);
     loadVisibleThumbnails();
 }
 
 void ThumbnailView::addItem() {
-    insertItem(thumbnails.count());
+    insertItem(itemCount());
 }
 
 // insert at index
 void ThumbnailView::insertItem(int index) {
-    ThumbnailWidget *widget = createThumbnailWidget();
-    thumbnails.insert(index, widget);
-    addItemToLayout(widget, index);
-    updateLayout();
+    if(index < 0 || index > itemCount())
+        return;
+    thumbs.insert(index, std::shared_ptr<Thumbnail>());
+    shiftWidgets(index, 1);
+    shiftLoaded(index, 1);
+    if(mDropHovered >= index)
+        mDropHovered++;
+    positionWidgets(index);
     fitSceneToContents();
 
     auto newSelection = mSelection;
@@ -311,8 +286,17 @@ void ThumbnailView::removeItem(int index) {
     if(checkRange(index)) {
         auto newSelection = mSelection;
         clearSelection();
-        removeItemFromLayout(index);
-        delete thumbnails.takeAt(index);
+        if(widgets.contains(index))
+            releaseWidget(widgets.take(index));
+        loadedSet.remove(index);
+        thumbs.remove(index);
+        shiftWidgets(index + 1, -1);
+        shiftLoaded(index + 1, -1);
+        if(mDropHovered == index)
+            mDropHovered = -1;
+        else if(mDropHovered > index)
+            mDropHovered--;
+        positionWidgets(index);
         fitSceneToContents();
         newSelection.removeAll(index);
         for(int i=0; i < newSelection.count(); i++) {
@@ -330,9 +314,7 @@ void ThumbnailView::removeItem(int index) {
 void ThumbnailView::reloadItem(int index) {
     if(!checkRange(index))
         return;
-    auto thumb = thumbnails.at(index);
-    if(thumb->isLoaded)
-        thumb->unsetThumbnail();
+    unloadThumbnail(index);
     emit thumbnailsRequested(QList<int>() << index, static_cast<int>(qApp->devicePixelRatio() * mThumbnailSize), mCropThumbnails, true);
 }
 
@@ -354,59 +336,96 @@ void ThumbnailView::setDrawScrollbarIndicator(bool mode) {
 
 void ThumbnailView::setThumbnail(int pos, std::shared_ptr<Thumbnail> thumb) {
     if(thumb && thumb->size() == floor(mThumbnailSize * qApp->devicePixelRatio()) && checkRange(pos)) {
-        thumbnails.at(pos)->setThumbnail(thumb);
+        // arrived after scrolling away
+        if(settings->snapshot()->unloadThumbs && (pos < preloadFirst || pos > preloadLast))
+            return;
+        atlas.setSlotSize(thumb->size());
+        thumb->moveToAtlas(atlas);
+        thumbs[pos] = thumb;
+        loadedSet.insert(pos);
+        if(widgets.contains(pos)) {
+            if(scrollDriver.isRunning())
+                pendingWidgets.append(widgets.value(pos));
+            else
+                widgets.value(pos)->setThumbnail(thumb);
+        }
     }
 }
 
 void ThumbnailView::unloadAllThumbnails() {
-    for(int i = 0; i < thumbnails.count(); i++) {
-        thumbnails.at(i)->unsetThumbnail();
-    }
+    for(auto i : loadedSet)
+        thumbs[i].reset();
+    loadedSet.clear();
+    for(auto widget : widgets)
+        widget->unsetThumbnail();
+    atlas.trim();
+}
+
+void ThumbnailView::unloadThumbnail(int index) {
+    thumbs[index].reset();
+    loadedSet.remove(index);
+    if(widgets.contains(index))
+        widgets.value(index)->unsetThumbnail();
 }
 
 void ThumbnailView::loadVisibleThumbnails() {
     loadTimer.stop();
-    if(isVisible() && !blockThumbnailLoading) {
-        QRectF visRect = mapToScene(viewport()->geometry()).boundingRect();
-        QRectF offRectBack;
-        QRectF offRectFront;
-        if(mOrientation == Qt::Horizontal) {
-            offRectBack  = QRectF(visRect.left() - offscreenPreloadArea, visRect.top(),
-                                  offscreenPreloadArea, visRect.height());
-            offRectFront = QRectF(visRect.right(), visRect.top(),
-                                  offscreenPreloadArea, visRect.height());
+    if(!blockThumbnailLoading)
+        requestThumbnails();
+}
+
+void ThumbnailView::requestThumbnails() {
+    if(!isVisible() || !itemCount())
+        return;
+    lastLoadPass.restart();
+    QRectF visRect = mapToScene(viewport()->geometry()).boundingRect();
+    int first, last, oldFirst = preloadFirst, oldLast = preloadLast;
+    itemsInRect(visRect, first, last);
+    itemsInRect(preloadRect(visRect), preloadFirst, preloadLast);
+    if(preloadLast < preloadFirst)
+        return;
+    if(last < first) {
+        first = preloadFirst;
+        last = preloadFirst - 1;
+    }
+    int size = static_cast<int>(floor(mThumbnailSize * qApp->devicePixelRatio()));
+    auto needsLoad = [&](int i) {
+        return !thumbs.at(i) || thumbs.at(i)->size() != size;
+    };
+    // visible ones first, then the offscreen ones nearest to the viewport
+    QList<int> loadList;
+    if(lastScrollDirection == SCROLL_FORWARDS) {
+        for(int i = first; i <= last; i++)
+            if(needsLoad(i))
+                loadList.append(i);
+    } else {
+        for(int i = last; i >= first; i--)
+            if(needsLoad(i))
+                loadList.append(i);
+    }
+    for(int i = first - 1; i >= preloadFirst; i--)
+        if(needsLoad(i))
+            loadList.append(i);
+    for(int i = last + 1; i <= preloadLast; i++)
+        if(needsLoad(i))
+            loadList.append(i);
+    // load
+    if(loadList.count())
+        emit thumbnailsRequested(loadList, static_cast<int>(qApp->devicePixelRatio() * mThumbnailSize), mCropThumbnails, false);
+    // unload offscreen
+    if(settings->snapshot()->unloadThumbs) {
+        // only what left the range since the last pass
+        // (inserts & removals may leave strays, sweep those once in a while)
+        if(loadedSet.count() > 2 * (preloadLast - preloadFirst + 1)) {
+            for(auto i : loadedSet.values())
+                if(i < preloadFirst || i > preloadLast)
+                    unloadThumbnail(i);
         } else {
-            offRectBack  = QRectF(visRect.left(), visRect.top() - offscreenPreloadArea,
-                                  visRect.width(), offscreenPreloadArea);
-            offRectFront = QRectF(visRect.left(), visRect.bottom(),
-                                  visRect.width(), offscreenPreloadArea);
-        }
-        QList<QGraphicsItem *>visibleItems;
-        if(lastScrollDirection == SCROLL_FORWARDS)
-            visibleItems = scene.items(visRect, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder);
-        else
-            visibleItems = scene.items(visRect, Qt::IntersectsItemBoundingRect, Qt::DescendingOrder);
-        visibleItems.append(scene.items(offRectBack,  Qt::IntersectsItemBoundingRect, Qt::DescendingOrder));
-        visibleItems.append(scene.items(offRectFront, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder));
-        // select
-        QList<int> loadList;
-        for(int i = 0; i < visibleItems.count(); i++) {
-            ThumbnailWidget* widget = qgraphicsitem_cast<ThumbnailWidget*>(visibleItems.at(i));
-            if(widget && !widget->isLoaded) {
-                int idx = thumbnails.indexOf(widget);
-                if(!loadList.contains(idx))
-                    loadList.append(idx);
-            }
-        }
-        // load
-        if(loadList.count())
-            emit thumbnailsRequested(loadList, static_cast<int>(qApp->devicePixelRatio() * mThumbnailSize), mCropThumbnails, false);
-        // unload offscreen
-        if(settings->unloadThumbs()) {
-            for(int i = 0; i < thumbnails.count(); i++)
-                if(!visibleItems.contains(thumbnails.at(i)))
-                    thumbnails.at(i)->unsetThumbnail();
+            for(int i = qMax(oldFirst, 0); i <= qMin(oldLast, itemCount() - 1); i++)
+                if((i < preloadFirst || i > preloadLast) && loadedSet.contains(i))
+                    unloadThumbnail(i);
         }
+        atlas.trim();
     }
 }
 
@@ -416,8 +435,7 @@ void ThumbnailView::loadVisibleThumbnailsDelayed() {
 }
 
 void ThumbnailView::resetViewport() {
-    if(scrollTimeLine->state() == QTimeLine::Running)
-        scrollTimeLine->stop();
+    stopScrolling();
     scrollBar->setValue(0);
 }
 
@@ -448,27 +466,130 @@ bool ThumbnailView::atSceneEnd() {
 }
 
 bool ThumbnailView::checkRange(int pos) {
-    return pos >= 0 && pos < thumbnails.count();
+    return pos >= 0 && pos < itemCount();
+}
+
+bool ThumbnailView::isSelected(int index) {
+    return mSelectionSet.contains(index);
 }
 
 void ThumbnailView::updateLayout() {
+    updateItemSize();
+    positionWidgets();
+}
+
+// assume all thumbnails are the same size
+void ThumbnailView::updateItemSize() {
+    std::unique_ptr<ThumbnailWidget> widget(createThumbnailWidget());
+    mItemSize = widget->boundingRect().size();
+}
 
+void ThumbnailView::positionWidgets(int from) {
+    for(auto it = widgets.begin(); it != widgets.end(); ++it)
+        if(it.key() >= from)
+            it.value()->setPos(itemRect(it.key()).topLeft());
+}
+
+QRectF ThumbnailView::preloadRect(QRectF visRect) {
+    if(mOrientation == Qt::Horizontal)
+        return visRect.adjusted(-offscreenPreloadArea, 0, offscreenPreloadArea, 0);
+    else
+        return visRect.adjusted(0, -offscreenPreloadArea, 0, offscreenPreloadArea);
+}
+
+void ThumbnailView::updateVisibleWidgets() {
+    int first = 0, last = -1;
+    if(itemCount() && !mItemSize.isEmpty())
+        itemsInRect(preloadRect(mapToScene(viewport()->geometry()).boundingRect()), first, last);
+    for(auto it = widgets.begin(); it != widgets.end();) {
+        if(it.key() < first || it.key() > last) {
+            releaseWidget(it.value());
+            it = widgets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for(int i = first; i <= last; i++) {
+        if(!widgets.contains(i))
+            widgets.insert(i, bindWidget(i));
+    }
+}
+
+ThumbnailWidget *ThumbnailView::bindWidget(int index) {
+    ThumbnailWidget *widget;
+    if(widgetPool.isEmpty()) {
+        widget = createThumbnailWidget();
+        scene.addItem(widget);
+    } else {
+        widget = widgetPool.takeLast();
+    }
+    widget->index = index;
+    widget->reset();
+    widget->setThumbnail(thumbs.at(index));
+    widget->setHighlighted(isSelected(index));
+    widget->setDropHovered(index == mDropHovered);
+    widget->setPos(itemRect(index).topLeft());
+    widget->show();
+    return widget;
+}
+
+void ThumbnailView::releaseWidget(ThumbnailWidget *widget) {
+    widget->hide();
+    widget->index = -1;
+    widget->unsetThumbnail();
+    widget->setDropHovered(false);
+    widgetPool.append(widget);
+}
+
+// moves indices of widgets at or after "from"
+void ThumbnailView::shiftWidgets(int from, int delta) {
+    QHash<int, ThumbnailWidget*> shifted;
+    for(auto it = widgets.begin(); it != widgets.end(); ++it) {
+        int index = it.key() >= from ? it.key() + delta : it.key();
+        it.value()->index = index;
+        shifted.insert(index, it.value());
+    }
+    widgets.swap(shifted);
+}
+
+void ThumbnailView::shiftLoaded(int from, int delta) {
+    QSet<int> shifted;
+    for(auto i : loadedSet)
+        shifted.insert(i >= from ? i + delta : i);
+    loadedSet.swap(shifted);
+}
+
+void ThumbnailView::forEachWidget(const std::function<void(ThumbnailWidget*)> &func) {
+    for(auto widget : widgets)
+        func(widget);
+    for(auto widget : widgetPool)
+        func(widget);
+}
+
+void ThumbnailView::setDropHovered(int index) {
+    if(widgets.contains(mDropHovered))
+        widgets.value(mDropHovered)->setDropHovered(false);
+    mDropHovered = checkRange(index) ? index : -1;
+    if(widgets.contains(mDropHovered))
+        widgets.value(mDropHovered)->setDropHovered(true);
 }
 
 // fit scene to it's contents size
 void ThumbnailView::fitSceneToContents() {
     QPointF center;
+    QSizeF size = contentsSize();
     if(this->mOrientation == Qt::Vertical) {
-        int height = qMax((int)scene.itemsBoundingRect().height(), this->height());
+        int height = qMax(static_cast<int>(size.height()), this->height());
         scene.setSceneRect(QRectF(0,0, this->width(), height));
         center = mapToScene(viewport()->rect().center());
         QGraphicsView::centerOn(0, center.y() + 1);
     } else {
-        int width = qMax((int)scene.itemsBoundingRect().width(), this->width());
+        int width = qMax(static_cast<int>(size.width()), this->width());
         scene.setSceneRect(QRectF(0,0, width, this->height()));
         center = mapToScene(viewport()->rect().center());
         QGraphicsView::centerOn(center.x() + 1, 0);
     }
+    updateVisibleWidgets();
 }
 
 //################### scrolling ######################
@@ -501,10 +622,7 @@ void ThumbnailView::scrollPrecise(int delta) {
     else
         lastScrollDirection = SCROLL_BACKWARDS;
     viewportCenter = mapToScene(viewport()->rect().center());
-    if(scrollTimeLine->state() == QTimeLine::Running) {
-        scrollTimeLine->stop();
-        blockThumbnailLoading = false;
-    }
+    stopScrolling();
     // ignore if we reached boundaries
     if( (delta > 0 && atSceneStart()) || (delta < 0 && atSceneEnd()) )
         return;
@@ -522,32 +640,26 @@ void ThumbnailView::scrollByItem(int delta) {
     int minScroll = qMin(thumbnailSize() / 2, 100);
     // grab fully visible thumbs
     QRectF visRect = mapToScene(viewport()->geometry()).boundingRect().adjusted(-minScroll,-minScroll,minScroll,minScroll);
-    QList<QGraphicsItem *> visibleItems;
-    visibleItems = scene.items(visRect, Qt::ContainsItemBoundingRect, Qt::AscendingOrder);
-    if(thumbnails.isEmpty() || visibleItems.isEmpty())
+    int first, last;
+    itemsInRect(visRect, first, last);
+    while(first <= last && !visRect.contains(itemRect(first)))
+        first++;
+    while(last >= first && !visRect.contains(itemRect(last)))
+        last--;
+    if(!itemCount() || last < first)
         return;
-    int target = 0;
     // select scroll target
-    if(delta > 0) { // up / left
-        ThumbnailWidget* widget = qgraphicsitem_cast<ThumbnailWidget*>(visibleItems.first());
-        if(!widget)
-            return;
-        target = thumbnails.indexOf(widget) - 1;
-    } else { // down / right
-        ThumbnailWidget* widget = qgraphicsitem_cast<ThumbnailWidget*>(visibleItems.last());
-        if(!widget)
-            return;
-        target = thumbnails.indexOf(widget) + 1;
-    }
-    scrollToItem(target);
+    if(delta > 0) // up / left
+        scrollToItem(first - 1);
+    else // down / right
+        scrollToItem(last + 1);
 }
 
 void ThumbnailView::scrollToItem(int index) {
     if(!checkRange(index))
         return;
-    ThumbnailWidget *item = thumbnails.at(index);
     QRectF sceneRect = mapToScene(viewport()->rect()).boundingRect();
-    QRectF itemRect = item->mapRectToScene(item->rect());
+    QRectF itemRect = this->itemRect(index);
     bool visible = sceneRect.contains(itemRect);
     if(!visible) {
         int delta = 0;
@@ -586,33 +698,23 @@ void ThumbnailView::scrollSmooth(int delta, qreal multiplier, qreal acceleration
         center = static_cast<int>(viewportCenter.y());
     bool redirect = false, accelerate = false;
     int newEndFrame = center - static_cast<int>(delta * multiplier);
-    if( (newEndFrame < center && center < scrollTimeLine->endFrame()) ||
-        (newEndFrame > center && center > scrollTimeLine->endFrame()) )
+    int oldEndFrame = scrollDriver.endValue();
+    if( (newEndFrame < center && center < oldEndFrame) ||
+        (newEndFrame > center && center > oldEndFrame) )
     {
         redirect = true;
     }
-    if(scrollTimeLine->state() == QTimeLine::Running || scrollTimeLine->state() == QTimeLine::Paused) {      
-        int oldEndFrame = scrollTimeLine->endFrame();
-        if(scrollTimeLine->currentTime() < SCROLL_ACCELERATION_THRESHOLD)
+    if(scrollDriver.isRunning()) {
+        if(scrollDriver.elapsed() < SCROLL_ACCELERATION_THRESHOLD)
             accelerate = true;
-        // QTimeLine has this weird issue when it is already finished (at the last frame)
-        // but is stuck in the running state. So we just create a new one.
-        if(oldEndFrame == center)
-            createScrollTimeLine();
         if(!redirect && additive)
             newEndFrame = oldEndFrame - static_cast<int>(delta * multiplier * acceleration);
-        // force load thumbs inbetween scroll animations
-        blockThumbnailLoading = false;
-        loadVisibleThumbnails();
     }
-    scrollTimeLine->stop();
+    int duration = SCROLL_DURATION;
     if(accelerate)
-        scrollTimeLine->setDuration(SCROLL_DURATION / SCROLL_ACCELERATION);
-    else
-        scrollTimeLine->setDuration(SCROLL_DURATION);
+        duration = static_cast<int>(SCROLL_DURATION / SCROLL_ACCELERATION);
     blockThumbnailLoading = true;
-    scrollTimeLine->setFrameRange(center, newEndFrame);
-    scrollTimeLine->start();
+    scrollDriver.start(center, newEndFrame, duration);
 }
 
 void ThumbnailView::scrollSmooth(int delta, qreal multiplier, qreal acceleration) {
@@ -628,10 +730,10 @@ void ThumbnailView::mousePressEvent(QMouseEvent *event) {
     dragStartPos = QPoint(0,0);
     ThumbnailWidget *item = dynamic_cast<ThumbnailWidget*>(itemAt(event->pos()));
     if(item) {
-        int index = thumbnails.indexOf(item);
+        int index = item->index;
         if(event->button() == Qt::LeftButton) {
             if(event->modifiers() & Qt::ControlModifier) {
-                if(!selection().contains(index))
+                if(!isSelected(index))
                     select(selection() << index);
                 else
                     deselect(index);
@@ -662,7 +764,7 @@ void ThumbnailView::mouseMoveEvent(QMouseEvent *event) {
         return;
     if(QLineF(dragStartPos, event->pos()).length() >= 40) {
         auto *item = dynamic_cast<ThumbnailWidget*>(itemAt(dragStartPos));
-        if(item && selection().contains(thumbnails.indexOf(item)))
+        if(item && isSelected(item->index))
             emit draggedOut();
     }
 }
@@ -671,10 +773,8 @@ void ThumbnailView::mouseReleaseEvent(QMouseEvent *event) {
     QGraphicsView::mouseReleaseEvent(event);
     if(mouseReleaseSelect && QLineF(dragStartPos, event->pos()).length() < 40) {
         ThumbnailWidget *item = dynamic_cast<ThumbnailWidget*>(itemAt(event->pos()));
-        if(item) {
-            int index = thumbnails.indexOf(item);
-            select(index);
-        }
+        if(item)
+            select(item->index);
     }
 }
 
@@ -682,7 +782,7 @@ void ThumbnailView::mouseDoubleClickEvent(QMouseEvent *event) {
     if(event->button() == Qt::LeftButton) {
         ThumbnailWidget *item = dynamic_cast<ThumbnailWidget*>(itemAt(event->pos()));
         if(item) {
-            emit itemActivated(thumbnails.indexOf(item));
+            emit itemActivated(item->index);
             return;
         }
     }
@@ -708,6 +808,7 @@ void ThumbnailView::keyReleaseEvent(QKeyEvent *event) {
 
 void ThumbnailView::resizeEvent(QResizeEvent *event) {
     QGraphicsView::resizeEvent(event);
+    updateVisibleWidgets();
     updateScrollbarIndicator();
 }
 
@@ -1,9 +1,13 @@
 #pragma once
 
-/* This class manages QGraphicsScene, ThumbnailWidget list,
+/* This class manages QGraphicsScene, ThumbnailWidgets,
  * scrolling, requesting and setting thumbnails.
  * It doesn't do actual positioning of thumbnails within the scene.
- * (But maybe it should?)
+ *
+ * Items are virtual: only the ones near the viewport get a widget,
+ * taken from a pool of recycled ones. Subclasses map indices to
+ * scene rects arithmetically, so the item count only costs memory
+ * for the loaded thumbnails list.
  *
  * Usage: subclass, implement layout-related stuff
  */
@@ -13,12 +17,16 @@
 #include <QHBoxLayout>
 #include <QScrollBar>
 #include <QWheelEvent>
-#include <QTimeLine>
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QScreen>
+#include <QHash>
+#include <QSet>
+#include <functional>
 
 #include "gui/customwidgets/thumbnailwidget.h"
+#include "gui/scrolldriver.h"
+#include "gui/thumbnailatlas.h"
 #include "gui/idirectoryview.h"
 #include "shortcutbuilder.h"
 
@@ -77,8 +85,31 @@ signals:
 private:
     QTimer loadTimer;
     bool blockThumbnailLoading;
-
-    int mDrawScrollbarIndicator, lastScrollFrameTime;
+    QList<ThumbnailWidget*> widgetPool; // unused, hidden
+    QSet<int> mSelectionSet;
+    int mDropHovered = -1;
+    // indices with a thumbnail in thumbs
+    QSet<int> loadedSet;
+    // preload range of the last loadVisibleThumbnails() pass
+    int preloadFirst = 0, preloadLast = -1;
+    // got a thumbnail while scrolling, shown from idle slices
+    QList<ThumbnailWidget*> pendingWidgets;
+    QElapsedTimer lastLoadPass;
+    // pixels of all loaded thumbnails
+    ThumbnailAtlas atlas;
+
+    ThumbnailWidget *bindWidget(int index);
+    void releaseWidget(ThumbnailWidget *widget);
+    void shiftWidgets(int from, int delta);
+    void shiftLoaded(int from, int delta);
+    void unloadThumbnail(int index);
+    QRectF preloadRect(QRectF visRect);
+    void requestThumbnails();
+    void applyPendingThumbnails(bool withinBudget);
+    void onScrollIdle();
+    void stopScrolling();
+
+    int mDrawScrollbarIndicator;
     QList<int> mSelection;
 
     bool mCropThumbnails, mouseReleaseSelect;
@@ -86,17 +117,19 @@ private:
     QPoint dragStartPos;
     ThumbnailWidget* dragTarget;
 
-    void createScrollTimeLine();
-    QElapsedTimer scrollFrameTimer;
     std::function<void(int)> centerOn;
     QElapsedTimer lastTouchpadScroll;
     Qt::Orientation mOrientation = Qt::Horizontal;
 
 protected:
     QGraphicsScene scene;
-    QList<ThumbnailWidget*> thumbnails;
+    // loaded thumbnails by index; this defines the item count
+    QVector<std::shared_ptr<Thumbnail>> thumbs;
+    // widgets currently in use, by index
+    QHash<int, ThumbnailWidget*> widgets;
+    QSizeF mItemSize;
     QScrollBar *scrollBar;
-    QTimeLine *scrollTimeLine;
+    ScrollDriver scrollDriver;
     QPointF viewportCenter;
     int mThumbnailSize;
     int offscreenPreloadArea = 3000;
@@ -107,7 +140,6 @@ protected:
     QRect indicator;
     const int indicatorSize = 2;
 
-    int scrollRefreshRate = 16;
     const int SCROLL_DURATION = 120;
     const float SCROLL_MULTIPLIER = 2.5f;
     const float SCROLL_ACCELERATION = 1.4f;
@@ -120,15 +152,27 @@ protected:
     bool atSceneEnd();
 
     bool checkRange(int pos);
+    bool isSelected(int index);
 
     virtual ThumbnailWidget *createThumbnailWidget() = 0;
-    virtual void addItemToLayout(ThumbnailWidget* widget, int pos) = 0;
-    virtual void removeItemFromLayout(int pos) = 0;
-    virtual void removeAll() = 0;
+    // scene rect of an item
+    virtual QRectF itemRect(int index) = 0;
+    // items intersecting the rect; last < first if none
+    virtual void itemsInRect(QRectF rect, int &first, int &last) = 0;
+    virtual QSizeF contentsSize() = 0;
     virtual void updateLayout();
     virtual void fitSceneToContents();
     virtual void updateScrollbarIndicator() = 0;
 
+    void updateItemSize();
+    // moves widgets of items starting at "from" to their place
+    void positionWidgets(int from = 0);
+    // bind widgets to items near the viewport, recycle the rest
+    void updateVisibleWidgets();
+    // applies to every widget, including pooled ones
+    void forEachWidget(const std::function<void(ThumbnailWidget*)> &func);
+    void setDropHovered(int index);
+
     void setOrientation(Qt::Orientation _orientation);
     Qt::Orientation orientation();
 
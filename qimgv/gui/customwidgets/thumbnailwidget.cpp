@@ -3,6 +3,7 @@
 ThumbnailWidget::ThumbnailWidget(QGraphicsItem *parent) :
     QGraphicsWidget(parent),
     isLoaded(false),
+    index(-1),
     thumbnail(nullptr),
     highlighted(false),
     hovered(false),
@@ -16,9 +17,8 @@ ThumbnailWidget::ThumbnailWidget(QGraphicsItem *parent) :
     thumbStyle(THUMB_SIMPLE)
 {
     setAttribute(Qt::WA_OpaquePaintEvent, true);
-    float dpr = qApp->devicePixelRatio();
-    if(trunc(dpr) == dpr) // don't enable for fractional scaling
-        setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    // no item cache: the thumbnail comes from an atlas and the label is cached,
+    // so a repaint is cheap and a cached copy would double the memory
     setAcceptHoverEvents(true);
     font.setBold(false);
     QFontMetrics fm(font);
@@ -56,6 +56,7 @@ int ThumbnailWidget::thumbnailSize() {
 void ThumbnailWidget::reset() {
     if(thumbnail)
         thumbnail.reset();
+    labelCache = QPixmap();
     highlighted = false;
     hovered = false;
     isLoaded = false;
@@ -93,7 +94,8 @@ QSizeF ThumbnailWidget::effectiveSizeHint(Qt::SizeHint which, const QSizeF &cons
 void ThumbnailWidget::setThumbnail(std::shared_ptr<Thumbnail> _thumbnail) {
     if(_thumbnail) {
         thumbnail = _thumbnail;
-        isLoaded = true;
+        // one made for another size is shown scaled until replaced
+        isLoaded = (thumbnail->size() == floor(mThumbnailSize * qApp->devicePixelRatio()));
         updateThumbnailDrawPosition();
         setupTextLayout();
         updateBackgroundRect();
@@ -104,10 +106,12 @@ void ThumbnailWidget::setThumbnail(std::shared_ptr<Thumbnail> _thumbnail) {
 void ThumbnailWidget::unsetThumbnail() {
     if(thumbnail)
         thumbnail.reset();
+    labelCache = QPixmap();
     isLoaded = false;
 }
 
 void ThumbnailWidget::setupTextLayout() {
+    labelCache = QPixmap();
     if(thumbStyle != THUMB_SIMPLE) {
         nameRect = QRect(padding + marginX,
                           padding + marginY + mThumbnailSize + labelSpacing,
@@ -122,7 +126,7 @@ void ThumbnailWidget::updateBackgroundRect() {
         bgRect.setBottom(height() - marginY);
         bgRect.setLeft(marginX);
         bgRect.setRight(width() - marginX);
-        if(!thumbnail || !thumbnail->pixmap())
+        if(!thumbnail || !thumbnail->texture())
             bgRect.setTop(drawRectCentered.top() - padding);
         else // ensure we get equal padding on the top & sides
             bgRect.setTop(qMax(drawRectCentered.top() - drawRectCentered.left() + marginX, marginY));
@@ -192,7 +196,7 @@ void ThumbnailWidget::paint(QPainter *painter, const QStyleOptionGraphicsItem *o
             ImageLib::recolor(loadingIcon, settings->colorScheme().folderview_hc2);
         drawIcon(painter, &loadingIcon);
     } else {
-        if(!thumbnail->pixmap() || thumbnail->pixmap().get()->width() == 0) { // invalid thumb
+        if(!thumbnail->texture() || thumbnail->textureRect().isEmpty()) { // invalid thumb
             QPixmap errorIcon(*shrRes->getPixmap(ShrIcon::SHR_ICON_ERROR, dpr));
             if(isHighlighted())
                 ImageLib::recolor(errorIcon, settings->colorScheme().accent);
@@ -200,7 +204,7 @@ void ThumbnailWidget::paint(QPainter *painter, const QStyleOptionGraphicsItem *o
                 ImageLib::recolor(errorIcon, settings->colorScheme().folderview_hc2);
             drawIcon(painter, &errorIcon);
         } else {
-            drawThumbnail(painter, thumbnail->pixmap().get());
+            drawThumbnail(painter);
             if(isHovered())
                 drawHoverHighlight(painter);
         }
@@ -239,21 +243,33 @@ void ThumbnailWidget::drawHoverHighlight(QPainter *painter) {
     auto mode = painter->compositionMode();
     painter->setCompositionMode(QPainter::CompositionMode_Plus);
     painter->setOpacity(0.2f);
-    painter->drawPixmap(drawRectCentered, *thumbnail->pixmap());
+    painter->drawPixmap(drawRectCentered, *thumbnail->texture(), thumbnail->textureRect());
     painter->setOpacity(op);
     painter->setCompositionMode(mode);
 }
 
 void ThumbnailWidget::drawLabel(QPainter *painter) {
     if(thumbnail) {
-        drawSingleLineText(painter, nameRect, thumbnail->name(), settings->colorScheme().text_hc2);
-        auto op = painter->opacity();
-        painter->setOpacity(op * 0.62f);
-        drawSingleLineText(painter, infoRect, thumbnail->info(), settings->colorScheme().text_hc2);
-        painter->setOpacity(op);
+        if(labelCache.isNull())
+            updateLabelCache();
+        painter->drawPixmap(nameRect.united(infoRect).topLeft(), labelCache);
     }
 }
 
+// text is rendered once per item instead of on every paint
+void ThumbnailWidget::updateLabelCache() {
+    qreal dpr = qApp->devicePixelRatio();
+    QRect labelRect = nameRect.united(infoRect);
+    labelCache = QPixmap(labelRect.size() * dpr);
+    labelCache.setDevicePixelRatio(dpr);
+    labelCache.fill(Qt::transparent);
+    QPainter painter(&labelCache);
+    painter.translate(-labelRect.topLeft());
+    drawSingleLineText(&painter, nameRect, thumbnail->name(), settings->colorScheme().text_hc2);
+    painter.setOpacity(0.62f);
+    drawSingleLineText(&painter, infoRect, thumbnail->info(), settings->colorScheme().text_hc2);
+}
+
 void ThumbnailWidget::drawSingleLineText(QPainter *painter, QRect rect, QString text, const QColor &color) {
     qreal dpr = qApp->devicePixelRatio();
     QFontMetrics fm(font);
@@ -306,10 +322,10 @@ void ThumbnailWidget::drawDropHover(QPainter *painter) {
     painter->setRenderHints(hints);
 }
 
-void ThumbnailWidget::drawThumbnail(QPainter* painter, const QPixmap *pixmap) {
+void ThumbnailWidget::drawThumbnail(QPainter* painter) {
     if(!thumbnail->hasAlphaChannel())
         painter->fillRect(drawRectCentered.adjusted(3,3,3,3), QColor(0,0,0, 60));
-    painter->drawPixmap(drawRectCentered, *pixmap);
+    painter->drawPixmap(drawRectCentered, *thumbnail->texture(), thumbnail->textureRect());
 }
 
 void ThumbnailWidget::drawIcon(QPainter* painter, const QPixmap *pixmap) {
@@ -347,13 +363,13 @@ bool ThumbnailWidget::isHovered() {
 }
 
 void ThumbnailWidget::updateThumbnailDrawPosition() {
-    if(thumbnail && thumbnail->pixmap()) {
+    if(thumbnail && thumbnail->texture()) {
         QPoint topLeft;
         QSize pixmapSize; // dpr-adjusted size
         if(isLoaded)
-            pixmapSize = thumbnail->pixmap()->size() / qApp->devicePixelRatio();
+            pixmapSize = thumbnail->textureSize();
         else
-            pixmapSize = thumbnail->pixmap()->size().scaled(mThumbnailSize, mThumbnailSize, Qt::KeepAspectRatio);
+            pixmapSize = thumbnail->textureRect().size().scaled(mThumbnailSize, mThumbnailSize, Qt::KeepAspectRatio);
         bool verticalFit = (pixmapSize.height() >= pixmapSize.width());
         topLeft.setX((width()  - pixmapSize.width())  / 2.0);
         if(thumbStyle == THUMB_SIMPLE)
@@ -29,6 +29,8 @@ public:
     int type() const override { return Type; }
 
     bool isLoaded;
+    // item this widget currently shows; -1 when unused
+    int index;
     void setThumbnail(std::shared_ptr<Thumbnail> _thumbnail);
 
     void setHighlighted(bool mode);
@@ -56,12 +58,13 @@ public:
 
 protected:
     void setupTextLayout();
-    void drawThumbnail(QPainter* painter, const QPixmap *pixmap);
+    void drawThumbnail(QPainter* painter);
     void drawIcon(QPainter *painter, const QPixmap *pixmap);
     void drawHighlight(QPainter *painter);
     void drawHoverBg(QPainter *painter);
     void drawHoverHighlight(QPainter *painter);
     void drawLabel(QPainter *painter);
+    void updateLabelCache();
     void drawDropHover(QPainter *painter);
     void drawSingleLineText(QPainter *painter, QRect rect, QString text, const QColor &color);
     void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
@@ -80,6 +83,8 @@ protected:
     QRectF bgRect, mBoundingRect;
     QFont font, fontInfo;
     QRect drawRectCentered, nameRect, infoRect;
+    // name & info text; null until first drawn
+    QPixmap labelCache;
     void updateBoundingRect();
     ThumbnailStyle thumbStyle;
 };
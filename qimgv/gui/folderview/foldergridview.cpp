@@ -6,6 +6,7 @@ FolderGridView::FolderGridView(QWidget *parent)
     : ThumbnailView(Qt::Vertical, parent),
       shiftedCol(-1)
 {
+    mThumbStyle = (settings->folderViewMode() == FV_SIMPLE) ? THUMB_SIMPLE : THUMB_NORMAL;
     offscreenPreloadArea = 2300;
 
     this->setAcceptDrops(true);
@@ -31,10 +32,9 @@ void FolderGridView::dropEvent(QDropEvent *event) {
     event->accept();
     ThumbnailWidget *item = dynamic_cast<ThumbnailWidget*>(itemAt(event->pos()));
     int index = -1;
-    if(item) {
-        index = thumbnails.indexOf(item);
-        item->setDropHovered(false);
-    }
+    if(item)
+        index = item->index;
+    setDropHovered(-1);
     emit droppedInto(event->mimeData(), event->source(), index);
 }
 
@@ -47,26 +47,19 @@ void FolderGridView::dragMoveEvent(QDragMoveEvent *event) {
     ThumbnailWidget *item = dynamic_cast<ThumbnailWidget*>(itemAt(event->pos()));
     int index = -1;
     if(item)
-        index = thumbnails.indexOf(item);
+        index = item->index;
     // unselect previous
-    if(index != lastDragTarget && checkRange(lastDragTarget))
-        thumbnails.at(lastDragTarget)->setDropHovered(false);
+    setDropHovered(-1);
     emit draggedOver(index);
-    lastDragTarget = index;
 }
 
 void FolderGridView::dragLeaveEvent(QDragLeaveEvent *event) {
     event->accept();
-    if(lastDragTarget < 0 || lastDragTarget >= thumbnails.count())
-        return;
-    thumbnails.at(lastDragTarget)->setDropHovered(false);
+    setDropHovered(-1);
 }
 
 void FolderGridView::setDragHover(int index) {
-    if(!checkRange(index))
-        return;
-    auto item = thumbnails.at(index);
-    item->setDropHovered(true);
+    setDropHovered(index);
 }
 
 void FolderGridView::onitemSelected() {
@@ -74,10 +67,10 @@ void FolderGridView::onitemSelected() {
 }
 
 void FolderGridView::updateScrollbarIndicator() {
-    if(!thumbnails.count() || !selection().count())
+    if(!itemCount() || !selection().count())
         return;
-    ThumbnailWidget *thumb = thumbnails.at(lastSelected());
-    qreal itemCenter = (thumb->pos().y() + (thumb->height() / 2)) / scene.height();
+    QRectF rect = itemRect(lastSelected());
+    qreal itemCenter = rect.center().y() / scene.height();
     indicator = QRect(2, scrollBar->height() * itemCenter - indicatorSize, scrollBar->width() - 4, indicatorSize);
 }
 
@@ -94,24 +87,24 @@ void FolderGridView::hide() {
 }
 
 void FolderGridView::setShowLabels(bool mode) {
-    ThumbnailStyle style = mode ? THUMB_NORMAL : THUMB_SIMPLE;
-    for(int i = 0; i < thumbnails.count(); i++)
-        thumbnails.at(i)->setThumbStyle(style);
+    mThumbStyle = mode ? THUMB_NORMAL : THUMB_SIMPLE;
+    forEachWidget([this](ThumbnailWidget *widget) {
+        widget->setThumbStyle(mThumbStyle);
+    });
     updateLayout();
     fitSceneToContents();
     focusOnSelection();
 }
 
 void FolderGridView::focusOnSelection() {
-    if(!thumbnails.count() || lastSelected() == -1)
+    if(!itemCount() || lastSelected() == -1)
         return;
-    ThumbnailWidget *thumb = thumbnails.at(lastSelected());
-    ensureVisible(thumb, 0, 0);
+    ensureVisible(itemRect(lastSelected()), 0, 0);
 }
 
 void FolderGridView::selectAll() {
     QList<int> list;
-    for(int i = 0; i < thumbnails.count(); i++)
+    for(int i = 0; i < itemCount(); i++)
         list << i;
     // preserve last selected index by putting it at the end of a new selection
     // this is simpler but it changes selection order a bit
@@ -123,12 +116,12 @@ void FolderGridView::selectAll() {
 }
 
 void FolderGridView::selectAbove() {
-    if(!thumbnails.count() || lastSelected() == -1 || flowLayout->sameRow(0, lastSelected()))
+    if(!itemCount() || lastSelected() == -1 || grid.sameRow(0, lastSelected()))
         return;
     int newIndex;
-    newIndex = flowLayout->itemAbove(lastSelected());
+    newIndex = grid.itemAbove(lastSelected());
     if(shiftedCol >= 0) {
-        int diff = shiftedCol - flowLayout->columnOf(lastSelected());
+        int diff = shiftedCol - grid.columnOf(lastSelected());
         newIndex += diff;
         shiftedCol = -1;
     }
@@ -142,14 +135,14 @@ void FolderGridView::selectAbove() {
 }
 
 void FolderGridView::selectBelow() {
-    if(!thumbnails.count() || lastSelected() == -1 || flowLayout->sameRow(lastSelected(), thumbnails.count() - 1))
+    if(!itemCount() || lastSelected() == -1 || grid.sameRow(lastSelected(), itemCount() - 1))
         return;
     shiftedCol = -1;
-    int newIndex = flowLayout->itemBelow(lastSelected());
+    int newIndex = grid.itemBelow(lastSelected());
     if(!checkRange(newIndex))
-        newIndex = thumbnails.count() - 1;
-    if(flowLayout->columnOf(newIndex) != flowLayout->columnOf(lastSelected()))
-        shiftedCol = flowLayout->columnOf(lastSelected());
+        newIndex = itemCount() - 1;
+    if(grid.columnOf(newIndex) != grid.columnOf(lastSelected()))
+        shiftedCol = grid.columnOf(lastSelected());
     if(rangeSelection)
         addSelectionRange(newIndex);
     else
@@ -158,16 +151,16 @@ void FolderGridView::selectBelow() {
 }
 
 void FolderGridView::selectNext() {
-    if(!thumbnails.count() || lastSelected() == thumbnails.count() - 1)
+    if(!itemCount() || lastSelected() == itemCount() - 1)
         return;
-    if(!rangeSelection && lastSelected() == thumbnails.count() - 1) {
+    if(!rangeSelection && lastSelected() == itemCount() - 1) {
         select(lastSelected());
         return;
     }
     shiftedCol = -1;
     int newIndex = lastSelected() + 1;
     if(!checkRange(newIndex))
-        newIndex = thumbnails.count() - 1;
+        newIndex = itemCount() - 1;
     if(rangeSelection)
         addSelectionRange(newIndex);
     else
@@ -176,7 +169,7 @@ void FolderGridView::selectNext() {
 }
 
 void FolderGridView::selectPrev() {
-    if(!thumbnails.count() || lastSelected() == 0)
+    if(!itemCount() || lastSelected() == 0)
         return;
     shiftedCol = -1;
     int newIndex = lastSelected() - 1;
@@ -190,18 +183,18 @@ void FolderGridView::selectPrev() {
 }
 
 void FolderGridView::pageUp() {
-    if(!thumbnails.count() || lastSelected() == -1 || flowLayout->sameRow(0, lastSelected()))
+    if(!itemCount() || lastSelected() == -1 || grid.sameRow(0, lastSelected()))
         return;
     int newIndex = lastSelected();
     int tmp;
     // 4 rows up
     for(int i = 0; i < 4; i++) {
-        tmp = flowLayout->itemAbove(newIndex);
+        tmp = grid.itemAbove(newIndex);
         if(checkRange(tmp))
             newIndex = tmp;
     }
     if(shiftedCol >= 0) {
-        int diff = shiftedCol - flowLayout->columnOf(newIndex);
+        int diff = shiftedCol - grid.columnOf(newIndex);
         newIndex += diff;
         shiftedCol = -1;
     }
@@ -213,19 +206,19 @@ void FolderGridView::pageUp() {
 }
 
 void FolderGridView::pageDown() {
-    if(!thumbnails.count() || lastSelected() == -1 || flowLayout->sameRow(lastSelected(), thumbnails.count() - 1))
+    if(!itemCount() || lastSelected() == -1 || grid.sameRow(lastSelected(), itemCount() - 1))
         return;
     shiftedCol = -1;
     int newIndex = lastSelected();
     int tmp;
     // 4 rows down
     for(int i = 0; i < 4; i++) {
-        tmp = flowLayout->itemBelow(newIndex);
+        tmp = grid.itemBelow(newIndex);
         if(checkRange(tmp))
             newIndex = tmp;
     }
-    if(flowLayout->columnOf(newIndex) != flowLayout->columnOf(lastSelected()))
-        shiftedCol = flowLayout->columnOf(lastSelected());
+    if(grid.columnOf(newIndex) != grid.columnOf(lastSelected()))
+        shiftedCol = grid.columnOf(lastSelected());
     if(rangeSelection)
         addSelectionRange(newIndex);
     else
@@ -234,7 +227,7 @@ void FolderGridView::pageDown() {
 }
 
 void FolderGridView::selectFirst() {
-    if(!thumbnails.count())
+    if(!itemCount())
         return;
     shiftedCol = -1;
     if(rangeSelection)
@@ -245,13 +238,13 @@ void FolderGridView::selectFirst() {
 }
 
 void FolderGridView::selectLast() {
-    if(!thumbnails.count())
+    if(!itemCount())
         return;
     shiftedCol = -1;
     if(rangeSelection)
-        addSelectionRange(thumbnails.count() - 1);
+        addSelectionRange(itemCount() - 1);
     else
-        select(thumbnails.count() - 1);
+        select(itemCount() - 1);
     scrollToCurrent();
 }
 
@@ -263,50 +256,50 @@ void FolderGridView::scrollToCurrent() {
 void FolderGridView::focusOn(int index) {
     if(!checkRange(index))
         return;
-    ThumbnailWidget *thumb = thumbnails.at(index);
-    ensureVisible(thumb, 0, 0);
+    ensureVisible(itemRect(index), 0, 0);
     loadVisibleThumbnailsDelayed();
 }
 
 void FolderGridView::setupLayout() {
     this->setAlignment(Qt::AlignHCenter);
-
-    flowLayout = new FlowLayout();
-    flowLayout->setContentsMargins(9,6,9,0);
     setFrameShape(QFrame::NoFrame);
-    scene.addItem(&holderWidget);
-    holderWidget.setLayout(flowLayout);
-    holderWidget.setContentsMargins(0,0,0,0);
+    grid.setMargins(QMargins(9, 6, 9, 0));
+    updateLayout();
 }
 
 ThumbnailWidget* FolderGridView::createThumbnailWidget() {
     ThumbnailWidget *widget = new ThumbnailWidget();
     widget->setPadding(8);
-    ThumbnailStyle style = (settings->folderViewMode() == FV_SIMPLE) ? THUMB_SIMPLE : THUMB_NORMAL;
-    widget->setThumbStyle(style);
+    widget->setThumbStyle(mThumbStyle);
     widget->setThumbnailSize(this->mThumbnailSize); // TODO: constructor
     return widget;
 }
 
-void FolderGridView::addItemToLayout(ThumbnailWidget* widget, int pos) {
-    scene.addItem(widget);
-    flowLayout->insertItem(pos, widget);
+QRectF FolderGridView::itemRect(int index) {
+    return grid.itemRect(index);
+}
+
+void FolderGridView::itemsInRect(QRectF rect, int &first, int &last) {
+    grid.itemsInRect(rect, first, last);
 }
 
-void FolderGridView::removeItemFromLayout(int pos) {
-    flowLayout->removeAt(pos);
+QSizeF FolderGridView::contentsSize() {
+    return QSizeF(width(), grid.contentsSize().height());
 }
 
-void FolderGridView::removeAll() {
-    flowLayout->clear();
-    qDeleteAll(thumbnails);
-    thumbnails.clear();
+// moves every widget only if the columns or centering changed
+void FolderGridView::updateGrid() {
+    grid.setWidth(scrollBar->isVisible() ? width() - scrollBar->width() : width());
+    grid.setCount(itemCount());
+    if(grid.takeChanged())
+        positionWidgets();
 }
 
 void FolderGridView::updateLayout() {
     shiftedCol = -1;
-    flowLayout->invalidate();
-    flowLayout->activate();
+    updateItemSize();
+    grid.setItemSize(mItemSize);
+    updateGrid();
 }
 
 // block native tab-switching so we can use it in shortcuts
@@ -390,22 +383,19 @@ void FolderGridView::zoomOut() {
 void FolderGridView::setThumbnailSize(int newSize) {
     newSize = clamp(newSize, THUMBNAIL_SIZE_MIN, THUMBNAIL_SIZE_MAX);
     mThumbnailSize = newSize;
-    for(int i = 0; i < thumbnails.count(); i++) {
-        thumbnails.at(i)->setThumbnailSize(newSize);
-    }
+    forEachWidget([newSize](ThumbnailWidget *widget) {
+        widget->setThumbnailSize(newSize);
+    });
     updateLayout();
     fitSceneToContents();
     if(lastSelected() != -1)
-        ensureVisible(thumbnails.at(lastSelected()), 0, 40);
+        ensureVisible(itemRect(lastSelected()), 0, 40);
     emit thumbnailSizeChanged(mThumbnailSize);
     loadVisibleThumbnails();
 }
 
 void FolderGridView::fitSceneToContents() {
-    if(scrollBar->isVisible())
-        holderWidget.setGeometry(0,0, width() - scrollBar->width(), height());
-    else
-        holderWidget.setGeometry(0,0, width(), height());
+    updateGrid();
     ThumbnailView::fitSceneToContents();
 }
 
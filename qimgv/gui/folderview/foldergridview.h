@@ -1,10 +1,8 @@
 #pragma once
 
-#include <QGraphicsWidget>
-
 #include "gui/customwidgets/thumbnailview.h"
 #include "gui/customwidgets/thumbnailwidget.h"
-#include "gui/flowlayout.h"
+#include "gui/gridlayout.h"
 #include "utils/stuff.h"
 #include "components/actionmanager/actionmanager.h"
 
@@ -40,11 +38,11 @@ public slots:
     virtual void setDragHover(int index) override;
 
 private:
-    FlowLayout *flowLayout;
-    QGraphicsWidget holderWidget;
+    GridLayout grid;
+    ThumbnailStyle mThumbStyle;
     int shiftedCol;
     void scrollToCurrent();
-    int lastDragTarget = -1;
+    void updateGrid();
 
 private slots:
     void onitemSelected();
@@ -52,11 +50,11 @@ private slots:
 protected:
     void resizeEvent(QResizeEvent *event) override;
     virtual void updateScrollbarIndicator() override;
-    void addItemToLayout(ThumbnailWidget *widget, int pos) override;
-    void removeItemFromLayout(int pos) override;
-    void removeAll() override;
     void setupLayout();
     ThumbnailWidget *createThumbnailWidget() override;
+    QRectF itemRect(int index) override;
+    void itemsInRect(QRectF rect, int &first, int &last) override;
+    QSizeF contentsSize() override;
     void updateLayout() override;
     virtual void fitSceneToContents() override;
 
@@ -0,0 +1,129 @@
+#include "gridlayout.h"
+
+GridLayout::GridLayout()
+    : mWidth(0),
+      mCount(0),
+      dirty(true),
+      changed(false),
+      mColumns(1),
+      centerOffset(0)
+{
+}
+
+void GridLayout::setItemSize(QSizeF size) {
+    if(mItemSize != size) {
+        mItemSize = size;
+        dirty = true;
+        changed = true;
+    }
+}
+
+void GridLayout::setMargins(QMargins margins) {
+    if(mMargins != margins) {
+        mMargins = margins;
+        dirty = true;
+        changed = true;
+    }
+}
+
+void GridLayout::setWidth(qreal width) {
+    if(mWidth != width) {
+        mWidth = width;
+        dirty = true;
+    }
+}
+
+void GridLayout::setCount(int count) {
+    if(mCount != count) {
+        mCount = count;
+        dirty = true;
+    }
+}
+
+bool GridLayout::takeChanged() {
+    update();
+    bool result = changed;
+    changed = false;
+    return result;
+}
+
+void GridLayout::update() const {
+    if(!dirty)
+        return;
+    dirty = false;
+    int columns = 1;
+    qreal offset = 0;
+    if(mItemSize.width() > 0) {
+        qreal rowWidth = mWidth - mMargins.left() - mMargins.right();
+        int maxColumns = static_cast<int>(rowWidth / mItemSize.width());
+        if(maxColumns > 1)
+            columns = maxColumns;
+        // center full rows; a single short row stays on the left
+        if(mCount >= maxColumns && maxColumns > 0)
+            offset = static_cast<int>(fmod(rowWidth, mItemSize.width()) / 2);
+    }
+    if(columns != mColumns || offset != centerOffset)
+        changed = true;
+    mColumns = columns;
+    centerOffset = offset;
+}
+
+QSizeF GridLayout::itemSize() const {
+    return mItemSize;
+}
+
+int GridLayout::columns() const {
+    update();
+    return mColumns;
+}
+
+QRectF GridLayout::itemRect(int index) const {
+    update();
+    return QRectF(mMargins.left() + centerOffset + (index % mColumns) * mItemSize.width(),
+                  mMargins.top() + (index / mColumns) * mItemSize.height(),
+                  mItemSize.width(), mItemSize.height());
+}
+
+void GridLayout::itemsInRect(QRectF rect, int &first, int &last) const {
+    first = 0;
+    last = -1;
+    if(!mCount || mItemSize.isEmpty())
+        return;
+    update();
+    int firstRow = static_cast<int>(floor((rect.top() - mMargins.top()) / mItemSize.height()));
+    int lastRow = static_cast<int>(floor((rect.bottom() - mMargins.top()) / mItemSize.height()));
+    first = qMax(firstRow, 0) * mColumns;
+    last = qMin((lastRow + 1) * mColumns, mCount) - 1;
+}
+
+QSizeF GridLayout::contentsSize() const {
+    update();
+    int rows = (mCount + mColumns - 1) / mColumns;
+    return QSizeF(mWidth, mMargins.top() + rows * mItemSize.height() + mMargins.bottom());
+}
+
+int GridLayout::itemAbove(int index) const {
+    if(index < 0 || index >= mCount)
+        return -1;
+    int indexAbove = index - columns();
+    return (indexAbove >= 0) ? indexAbove : index;
+}
+
+int GridLayout::itemBelow(int index) const {
+    if(index < 0 || index >= mCount)
+        return -1;
+    if(sameRow(index, mCount - 1))
+        return index;
+    int indexBelow = index + columns();
+    return (indexBelow < mCount) ? indexBelow : mCount - 1;
+}
+
+int GridLayout::columnOf(int index) const {
+    if(index < 0 || index >= mCount)
+        return -1;
+    return index % columns();
+}
+
+bool GridLayout::sameRow(int one, int two) const {
+    return (one / columns()) == (two / columns());
+}
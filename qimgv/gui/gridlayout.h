@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QRectF>
+#include <QMargins>
+#include <cmath>
+
+// Positions of equally sized items in rows, centered horizontally.
+// Everything is computed from the index; nothing is stored per item,
+// so inserting or removing an item only moves the ones after it.
+// The column count is recalculated lazily, on first use after a change.
+class GridLayout {
+public:
+    GridLayout();
+    void setItemSize(QSizeF size);
+    void setMargins(QMargins margins);
+    void setWidth(qreal width);
+    void setCount(int count);
+
+    // true if positions of existing items changed since the last call
+    // (column count or centering), meaning every placed item has to move
+    bool takeChanged();
+
+    QSizeF itemSize() const;
+    int columns() const;
+    QRectF itemRect(int index) const;
+    // items intersecting the rect; last < first if none
+    void itemsInRect(QRectF rect, int &first, int &last) const;
+    QSizeF contentsSize() const;
+
+    // index of item above / below
+    int itemAbove(int index) const;
+    int itemBelow(int index) const;
+    int columnOf(int index) const;
+    bool sameRow(int one, int two) const;
+
+private:
+    QSizeF mItemSize;
+    QMargins mMargins;
+    qreal mWidth;
+    int mCount;
+    mutable bool dirty, changed;
+    mutable int mColumns;
+    mutable qreal centerOffset;
+    void update() const;
+};
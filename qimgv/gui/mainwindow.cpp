@@ -12,6 +12,7 @@ MW::MW(QWidget *parent)
       renameOverlay(nullptr),
       infoBarFullscreen(nullptr),
       imageInfoOverlay(nullptr),
+      metricsOverlay(nullptr),
       floatingMessage(nullptr),
       cropPanel(nullptr),
       cropOverlay(nullptr)
@@ -323,6 +324,23 @@ void MW::toggleImageInfoOverlay() {
         imageInfoOverlay->hide();
 }
 
+void MW::toggleMetricsOverlay() {
+    if(!metricsOverlay) {
+        metricsOverlay = new MetricsOverlay(viewerWidget.get());
+        metricsOverlay->setPrefetchStats(prefetchStats);
+    }
+    if(metricsOverlay->isHidden())
+        metricsOverlay->show();
+    else
+        metricsOverlay->hide();
+}
+
+void MW::setPrefetchStats(const PrefetchStats &stats) {
+    prefetchStats = stats;
+    if(metricsOverlay)
+        metricsOverlay->setPrefetchStats(stats);
+}
+
 void MW::toggleRenameOverlay(QString currentName) {
     if(!renameOverlay)
         setupRenameOverlay();
@@ -27,6 +27,7 @@
 #include "gui/overlays/changelogwindow.h"
 #include "gui/overlays/imageinfooverlayproxy.h"
 #include "gui/overlays/renameoverlay.h"
+#include "gui/overlays/metricsoverlay.h"
 #include "gui/dialogs/resizedialog.h"
 #include "gui/centralwidget.h"
 #include "gui/dialogs/filereplacedialog.h"
@@ -73,6 +74,7 @@ public:
 
     void setCurrentInfo(int fileIndex, int fileCount, QString filePath, QString fileName, QSize imageSize, qint64 fileSize, bool slideshow, bool shuffle, bool edited);
     void setExifInfo(QMap<QString, QString>);
+    void setPrefetchStats(const PrefetchStats &stats);
     std::shared_ptr<FolderViewProxy> getFolderView();
     std::shared_ptr<ThumbnailStripProxy> getThumbnailPanel();
 
@@ -104,6 +106,9 @@ private:
 
     ImageInfoOverlayProxy *imageInfoOverlay;
 
+    MetricsOverlay *metricsOverlay;
+    PrefetchStats prefetchStats;
+
     ControlsOverlay *controlsOverlay;
     FullscreenInfoOverlayProxy *infoBarFullscreen;
     std::shared_ptr<InfoBarProxy> infoBarWindowed;
@@ -252,4 +257,5 @@ public slots:
     void toggleLockZoom();
     void toggleLockView();
     void toggleFullscreenInfoBar();
+    void toggleMetricsOverlay();
 };
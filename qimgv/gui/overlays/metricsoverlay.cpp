@@ -0,0 +1,48 @@
+#include "metricsoverlay.h"
+
+MetricsOverlay::MetricsOverlay(FloatingWidgetContainer *parent) : OverlayWidget(parent) {
+    layout.setContentsMargins(10, 8, 10, 8);
+    layout.addWidget(&label);
+    label.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    this->setLayout(&layout);
+    this->setPosition(FloatingWidgetPosition::TOPLEFT);
+    setAttribute(Qt::WA_TransparentForMouseEvents, true);
+    connect(navMetrics, &NavigationMetrics::updated, this, &MetricsOverlay::updateReport);
+    refreshTimer.setInterval(1000);
+    connect(&refreshTimer, &QTimer::timeout, this, &MetricsOverlay::updateReport);
+
+    if(parent)
+        setContainerSize(parent->size());
+}
+
+void MetricsOverlay::setPrefetchStats(const PrefetchStats &stats) {
+    prefetchStats = stats;
+    if(!isHidden())
+        updateReport();
+}
+
+void MetricsOverlay::show() {
+    updateReport();
+    OverlayWidget::show();
+    refreshTimer.start();
+}
+
+void MetricsOverlay::updateReport() {
+    if(isHidden() && sender()) {
+        refreshTimer.stop();
+        return;
+    }
+    QString prefetch = QString("prefetch: %1 files, %2 MB at %3 MB/s")
+            .arg(prefetchStats.files)
+            .arg(prefetchStats.bytes / 1048576)
+            .arg(prefetchStats.mbPerSecond(), 0, 'f', 1);
+    ScrollFrameStats scrollStats = ScrollDriver::lastStats();
+    QString scroll = QString("last scroll: %1 frames, avg %2 ms, max %3 ms, %4 missed")
+            .arg(scrollStats.frames)
+            .arg(scrollStats.avgMs(), 0, 'f', 1)
+            .arg(scrollStats.maxMs(), 0, 'f', 1)
+            .arg(scrollStats.missed);
+    label.setText(navMetrics->report() + "\n\n" + MemoryMetrics::report() + "\n\n" + prefetch + "\n" + scroll);
+    adjustSize();
+    recalculateGeometry();
+}
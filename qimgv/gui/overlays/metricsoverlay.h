@@ -0,0 +1,32 @@
+#pragma once
+
+#include "gui/customwidgets/overlaywidget.h"
+#include "components/metrics/navigationmetrics.h"
+#include "components/metrics/memorymetrics.h"
+#include "components/prefetcher/prefetcherrunnable.h"
+#include "gui/scrolldriver.h"
+#include <QLabel>
+#include <QTimer>
+#include <QHBoxLayout>
+#include <QFontDatabase>
+
+// Navigation latency, memory, prefetch & scrolling stats, for debugging.
+class MetricsOverlay : public OverlayWidget {
+    Q_OBJECT
+public:
+    explicit MetricsOverlay(FloatingWidgetContainer *parent = nullptr);
+
+    void setPrefetchStats(const PrefetchStats &stats);
+
+public slots:
+    void show();
+
+private slots:
+    void updateReport();
+
+private:
+    QHBoxLayout layout;
+    QLabel label;
+    QTimer refreshTimer; // memory changes without navigation
+    PrefetchStats prefetchStats;
+};
@@ -10,7 +10,7 @@ ThumbnailStrip::ThumbnailStrip(QWidget *parent) : ThumbnailView(Qt::Horizontal,
 }
 
 void ThumbnailStrip::updateScrollbarIndicator() {
-    if(!thumbnails.count() || lastSelected() == -1)
+    if(!itemCount() || lastSelected() == -1)
         return;
     qreal itemCenter = (qreal)(lastSelected() + 0.5) / itemCount();
     if(scrollBar->orientation() == Qt::Horizontal)
@@ -34,78 +34,57 @@ ThumbnailWidget* ThumbnailStrip::createThumbnailWidget() {
     return widget;
 }
 
-void ThumbnailStrip::addItemToLayout(ThumbnailWidget* widget, int pos) {
-    scene.addItem(widget);
-    updateThumbnailPositions(pos, thumbnails.count() - 1);
-}
-
-void ThumbnailStrip::removeItemFromLayout(int pos) {
-    if(checkRange(pos)) {
-        ThumbnailWidget *thumb = thumbnails.at(pos);
-        scene.removeItem(thumb);
-        // move items
-        ThumbnailWidget *tmp;
-        if(orientation() == Qt::Horizontal) {
-            for(int i = pos; i < thumbnails.count(); i++) {
-                tmp = thumbnails.at(i);
-                tmp->moveBy(-tmp->boundingRect().width(), 0);
-            }
-        } else {
-            for(int i = pos; i < thumbnails.count(); i++) {
-                tmp = thumbnails.at(i);
-                tmp->moveBy(0, -tmp->boundingRect().height());
-            }
-        }
-    }
-}
-
-void ThumbnailStrip::removeAll() {
-    scene.clear(); // also calls delete on all items
-    thumbnails.clear();
-}
-
-void ThumbnailStrip::updateThumbnailPositions() {
-    updateThumbnailPositions(0, thumbnails.count() - 1);
+QRectF ThumbnailStrip::itemRect(int index) {
+    if(orientation() == Qt::Horizontal)
+        return QRectF(QPointF(index * mItemSize.width(), 0), mItemSize);
+    else
+        return QRectF(QPointF(0, index * mItemSize.height()), mItemSize);
 }
 
-void ThumbnailStrip::updateThumbnailPositions(int start, int end) {
-    if(start > end || !checkRange(start) || !checkRange(end))
+void ThumbnailStrip::itemsInRect(QRectF rect, int &first, int &last) {
+    first = 0;
+    last = -1;
+    if(!itemCount() || mItemSize.isEmpty())
         return;
-    // assume all thumbnails are the same size
-    ThumbnailWidget *tmp;
+    qreal start, end, step;
     if(orientation() == Qt::Horizontal) {
-        int thumbWidth = static_cast<int>(thumbnails.at(start)->boundingRect().width());
-        for(int i = start; i <= end; i++) {
-            tmp = thumbnails.at(i);
-            tmp->setPos(i * thumbWidth, 0);
-        }
+        start = rect.left();
+        end = rect.right();
+        step = mItemSize.width();
     } else {
-        int thumbHeight = static_cast<int>(thumbnails.at(start)->boundingRect().height());
-        for(int i = start; i <= end; i++) {
-            tmp = thumbnails.at(i);
-            tmp->setPos(0, i * thumbHeight);
-        }
+        start = rect.top();
+        end = rect.bottom();
+        step = mItemSize.height();
     }
+    first = qMax(static_cast<int>(floor(start / step)), 0);
+    last = qMin(static_cast<int>(floor(end / step)), itemCount() - 1);
+}
+
+QSizeF ThumbnailStrip::contentsSize() {
+    if(orientation() == Qt::Horizontal)
+        return QSizeF(itemCount() * mItemSize.width(), mItemSize.height());
+    else
+        return QSizeF(mItemSize.width(), itemCount() * mItemSize.height());
 }
 
 void ThumbnailStrip::focusOn(int index) {
     if(!checkRange(index))
         return;
-    auto th = thumbnails.at(index);
+    QRectF rect = itemRect(index);
     if(settings->panelCenterSelection()) {
-        QGraphicsView::centerOn(th->sceneBoundingRect().center());
+        QGraphicsView::centerOn(rect.center());
     } else {
         // partially show the next thumb if possible
         if(orientation() == Qt::Vertical) {
-            if(height() > th->height() * 2)
-                ensureVisible(th, 0, th->height()/2);
+            if(height() > rect.height() * 2)
+                ensureVisible(rect, 0, rect.height() / 2);
             else
-                ensureVisible(th, 0, 0);
+                ensureVisible(rect, 0, 0);
         } else {
-            if(width() > th->width() * 2)
-                ensureVisible(th, th->width() / 2, 0);
+            if(width() > rect.width() * 2)
+                ensureVisible(rect, rect.width() / 2, 0);
             else
-                ensureVisible(th, 0, 0);
+                ensureVisible(rect, 0, 0);
         }
     }
     loadVisibleThumbnails();
@@ -136,29 +115,20 @@ void ThumbnailStrip::readSettings() {
     }
 
     // apply style, size & reposition
-    for(int i = 0; i < thumbnails.count(); i++) {
-        thumbnails.at(i)->setPadding(thumbPadding);
-        thumbnails.at(i)->setMargins(thumbMarginX, thumbMarginY);
-        thumbnails.at(i)->setThumbStyle(mCurrentStyle);
-        thumbnails.at(i)->setThumbnailSize(mThumbnailSize);
-    }
-    updateThumbnailPositions(0, thumbnails.count() - 1);
+    forEachWidget([this](ThumbnailWidget *widget) {
+        widget->setPadding(thumbPadding);
+        widget->setMargins(thumbMarginX, thumbMarginY);
+        widget->setThumbStyle(mCurrentStyle);
+        widget->setThumbnailSize(mThumbnailSize);
+    });
+    updateLayout();
     fitSceneToContents();
     setCropThumbnails(settings->squareThumbnails());
     focusOn(lastSelected());
 }
 
 QSize ThumbnailStrip::itemSize() {
-    if(!thumbnails.count()) {
-        ThumbnailWidget w;
-        w.setPadding(thumbPadding);
-        w.setMargins(thumbMarginX, thumbMarginY);
-        w.setThumbStyle(mCurrentStyle);
-        w.setThumbnailSize(mThumbnailSize);
-        return w.boundingRect().size().toSize();
-    } else {
-        return thumbnails.at(0)->boundingRect().size().toSize();
-    }
+    return mItemSize.toSize();
 }
 
 void ThumbnailStrip::resizeEvent(QResizeEvent *event) {
@@ -26,8 +26,6 @@ public:
 private:
     const int thumbPadding = 9;
     int thumbMarginX = 2, thumbMarginY = 4;
-    void updateThumbnailPositions(int start, int end);
-    void updateThumbnailPositions();
     void setupLayout();
     ThumbnailStyle mCurrentStyle;
 
@@ -38,8 +36,8 @@ public slots:
 protected:
     virtual void resizeEvent(QResizeEvent *event);
     virtual void updateScrollbarIndicator();
-    void addItemToLayout(ThumbnailWidget *widget, int pos);
-    void removeItemFromLayout(int pos);
-    void removeAll();
     ThumbnailWidget *createThumbnailWidget();
+    QRectF itemRect(int index);
+    void itemsInRect(QRectF rect, int &first, int &last);
+    QSizeF contentsSize();
 };
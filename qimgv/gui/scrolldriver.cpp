@@ -0,0 +1,85 @@
+#include "scrolldriver.h"
+
+// share of a frame idle work may take; the rest is left for painting
+#define IDLE_BUDGET 0.5
+
+ScrollFrameStats ScrollDriver::mLastStats;
+
+ScrollDriver::ScrollDriver(QObject *parent)
+    : QObject(parent),
+      curve(QEasingCurve::OutSine),
+      mFrom(0),
+      mTo(0),
+      mDuration(1)
+{
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &ScrollDriver::onTick);
+    setRefreshRate(60);
+}
+
+void ScrollDriver::setRefreshRate(qreal hz) {
+    if(hz <= 0)
+        return;
+    frameNs = static_cast<qint64>(1000000000 / hz);
+    timer.setInterval(qMax(1, static_cast<int>(1000 / hz)));
+}
+
+void ScrollDriver::start(int from, int to, int duration) {
+    if(!timer.isActive()) {
+        mStats = ScrollFrameStats();
+        tickClock.invalidate();
+        timer.start();
+    }
+    mFrom = from;
+    mTo = to;
+    mDuration = qMax(1, duration);
+    clock.start();
+}
+
+void ScrollDriver::stop() {
+    timer.stop();
+}
+
+bool ScrollDriver::isRunning() const {
+    return timer.isActive();
+}
+
+int ScrollDriver::endValue() const {
+    return mTo;
+}
+
+qint64 ScrollDriver::elapsed() const {
+    return clock.isValid() ? clock.elapsed() : 0;
+}
+
+qint64 ScrollDriver::budgetLeftNs() const {
+    if(!timer.isActive() || !tickClock.isValid())
+        return 0;
+    return static_cast<qint64>(frameNs * IDLE_BUDGET) - tickClock.nsecsElapsed();
+}
+
+ScrollFrameStats ScrollDriver::lastStats() {
+    return mLastStats;
+}
+
+void ScrollDriver::onTick() {
+    if(tickClock.isValid()) {
+        qint64 interval = tickClock.nsecsElapsed();
+        mStats.totalNs += interval;
+        mStats.maxNs = qMax(mStats.maxNs, interval);
+        if(interval > frameNs * 3 / 2)
+            mStats.missed++;
+    }
+    mStats.frames++;
+    tickClock.start();
+    qreal progress = qMin(1.0, clock.nsecsElapsed() / (mDuration * 1000000.0));
+    emit valueChanged(mFrom + qRound((mTo - mFrom) * curve.valueForProgress(progress)));
+    if(progress >= 1.0) {
+        timer.stop();
+        mLastStats = mStats;
+        emit finished();
+        return;
+    }
+    if(budgetLeftNs() > 0)
+        emit idle();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QEasingCurve>
+#include <QDebug>
+
+struct ScrollFrameStats {
+    int frames = 0;
+    // frames which took over 1.5 refresh intervals
+    int missed = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+
+    qreal avgMs() const {
+        return (frames > 1) ? totalNs / (frames - 1) / 1000000.0 : 0;
+    }
+    qreal maxMs() const {
+        return maxNs / 1000000.0;
+    }
+};
+
+// Eased scroll animation ticking once per screen refresh.
+//
+// The value is computed from the time since start, not advanced per frame,
+// so a slow frame makes the next one jump ahead instead of stretching
+// the animation. Nothing here re-enters the event loop; repaints happen
+// between ticks as usual.
+//
+// After each frame idle() is emitted if some of the frame budget is left,
+// for work which can be spread over the animation (see budgetLeftNs()).
+class ScrollDriver : public QObject {
+    Q_OBJECT
+public:
+    explicit ScrollDriver(QObject *parent = nullptr);
+    void setRefreshRate(qreal hz);
+    // restarts from "from"; frame stats keep accumulating if already running
+    void start(int from, int to, int duration);
+    void stop();
+    bool isRunning() const;
+    int endValue() const;
+    // ms since start()
+    qint64 elapsed() const;
+    // part of the current frame which can still be spent in idle()
+    qint64 budgetLeftNs() const;
+    // of the last finished animation of any driver; GUI thread only
+    static ScrollFrameStats lastStats();
+
+signals:
+    void valueChanged(int value);
+    void idle();
+    void finished();
+
+private slots:
+    void onTick();
+
+private:
+    QTimer timer;
+    QElapsedTimer clock, tickClock;
+    QEasingCurve curve;
+    int mFrom, mTo, mDuration;
+    qint64 frameNs;
+    ScrollFrameStats mStats;
+    static ScrollFrameStats mLastStats;
+};
@@ -0,0 +1,87 @@
+#include "thumbnailatlas.h"
+
+// page width & height in pixels (rounded down to a multiple of the slot size)
+#define ATLAS_PAGE_SIZE 2048
+
+AtlasSlot::AtlasSlot(std::shared_ptr<AtlasPage> _page, int _slot, QSize size)
+    : page(_page),
+      slot(_slot)
+{
+    mRect = QRect(QPoint((slot % page->columns) * page->slotSize,
+                         (slot / page->columns) * page->slotSize), size);
+}
+
+AtlasSlot::~AtlasSlot() {
+    page->freeSlots.append(slot);
+}
+
+const QPixmap *AtlasSlot::pixmap() const {
+    return &page->pixmap;
+}
+
+QRect AtlasSlot::rect() const {
+    return mRect;
+}
+
+ThumbnailAtlas::ThumbnailAtlas()
+    : mSlotSize(0)
+{
+}
+
+void ThumbnailAtlas::setSlotSize(int size) {
+    if(mSlotSize != size) {
+        mSlotSize = size;
+        pages.clear();
+    }
+}
+
+int ThumbnailAtlas::slotSize() const {
+    return mSlotSize;
+}
+
+std::shared_ptr<AtlasSlot> ThumbnailAtlas::add(const QPixmap &pixmap) {
+    if(mSlotSize <= 0 || pixmap.isNull() || pixmap.width() > mSlotSize || pixmap.height() > mSlotSize)
+        return nullptr;
+    std::shared_ptr<AtlasPage> page;
+    for(auto p : pages) {
+        if(!p->freeSlots.isEmpty()) {
+            page = p;
+            break;
+        }
+    }
+    if(!page) {
+        page.reset(new AtlasPage());
+        page->slotSize = mSlotSize;
+        page->columns = qMax(1, ATLAS_PAGE_SIZE / mSlotSize);
+        page->pixmap = QPixmap(page->columns * mSlotSize, page->columns * mSlotSize);
+        page->pixmap.fill(Qt::transparent);
+        page->charge.set(MemoryMetrics::bytesOf(page->pixmap));
+        for(int i = page->columns * page->columns - 1; i >= 0; i--)
+            page->freeSlots.append(i);
+        pages.append(page);
+    }
+    std::shared_ptr<AtlasSlot> slot(new AtlasSlot(page, page->freeSlots.takeLast(), pixmap.size()));
+    QPainter painter(&page->pixmap);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawPixmap(slot->rect(), pixmap, pixmap.rect());
+    return slot;
+}
+
+void ThumbnailAtlas::trim() {
+    bool keptEmpty = false;
+    for(auto it = pages.begin(); it != pages.end();) {
+        auto page = *it;
+        if(page->freeSlots.count() == page->columns * page->columns) {
+            if(keptEmpty) {
+                it = pages.erase(it);
+                continue;
+            }
+            keptEmpty = true;
+        }
+        ++it;
+    }
+}
+
+int ThumbnailAtlas::pageCount() const {
+    return pages.count();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QPixmap>
+#include <QPainter>
+#include <QList>
+#include <memory>
+#include "components/metrics/memorymetrics.h"
+
+// Packs thumbnails of one size into a few large pixmaps.
+//
+// Each page is a grid of fixed, square slots the size of a thumbnail.
+// A slot is held by an AtlasSlot; destroying it (when the thumbnail is
+// unloaded) frees the slot for the next one. Slots keep their page alive,
+// so they stay valid after a size change or the atlas going away.
+//
+// GUI thread only.
+
+struct AtlasPage {
+    QPixmap pixmap;
+    int slotSize;
+    int columns;
+    QList<int> freeSlots;
+    MemoryCharge charge{MEM_THUMBNAILS};
+};
+
+class AtlasSlot {
+public:
+    AtlasSlot(std::shared_ptr<AtlasPage> page, int slot, QSize size);
+    ~AtlasSlot();
+    const QPixmap *pixmap() const;
+    // part of pixmap() holding the thumbnail, in pixels
+    QRect rect() const;
+
+private:
+    std::shared_ptr<AtlasPage> page;
+    int slot;
+    QRect mRect;
+};
+
+class ThumbnailAtlas {
+public:
+    ThumbnailAtlas();
+    // thumbnail size in pixels; pages of the old size are let go
+    void setSlotSize(int size);
+    int slotSize() const;
+    // copies the pixmap into a free slot
+    // returns nullptr if it does not fit
+    std::shared_ptr<AtlasSlot> add(const QPixmap &pixmap);
+    // frees pages with no slots in use, leaving one
+    void trim();
+    int pageCount() const;
+
+private:
+    QList<std::shared_ptr<AtlasPage>> pages;
+    int mSlotSize;
+};
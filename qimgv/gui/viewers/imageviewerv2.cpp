@@ -1,9 +1,20 @@
 #include "imageviewerv2.h"
+#include "utils/tracer.h"
+#include "components/metrics/navigationmetrics.h"
 
 ImageViewerV2::ImageViewerV2(QWidget *parent) : QGraphicsView(parent),
     pixmap(nullptr),
     pixmapScaled(nullptr),
-    movie(nullptr),
+    pixmapCharge(MEM_VIEWER_PIXMAPS),
+    scaledCharge(MEM_VIEWER_PIXMAPS),
+    animation(nullptr),
+    animationFrame(0),
+    pendingFrame(-1),
+    animationDelay(0),
+    animationRunning(false),
+    firstPaintPending(false),
+    finalPaintPending(false),
+    scalePending(false),
     transparencyGrid(false),
     expandImage(false),
     smoothAnimatedImages(true),
@@ -138,25 +149,25 @@ void ImageViewerV2::onFullscreenModeChanged(bool mode) {
 }
 
 void ImageViewerV2::startAnimation() {
-    if(movie && movie->frameCount() > 1) {
+    if(animation && animation->frameCount() != 1) {
         stopAnimation();
         emit animationPaused(false);
-        //movie->jumpToFrame(0);
-        //emit frameChanged(0);
-        animationTimer->start(movie->nextFrameDelay());
+        animationRunning = true;
+        animationTimer->start(animationDelay);
     }
 }
 
 void ImageViewerV2::stopAnimation() {
-    if(movie) {
+    if(animation) {
         emit animationPaused(true);
+        animationRunning = false;
         animationTimer->stop();
     }
 }
 
 void ImageViewerV2::pauseResume() {
-    if(movie) {
-        if(animationTimer->isActive())
+    if(animation) {
+        if(animationRunning)
             stopAnimation();
         else
             startAnimation();
@@ -164,72 +175,97 @@ void ImageViewerV2::pauseResume() {
 }
 
 void ImageViewerV2::onAnimationTimer() {
-    if(!movie)
+    if(!animation)
         return;
-    if(movie->currentFrameNumber() == movie->frameCount() - 1) {
+    int frameCount = animation->frameCount();
+    if(frameCount && animationFrame == frameCount - 1) {
         // last frame
         if(!loopPlayback) {
+            animationRunning = false;
             emit animationPaused(true);
             emit playbackFinished();
             return;
-        } else {
-            movie->jumpToFrame(0);
         }
+        requestAnimationFrame(0);
     } else {
-        if(!movie->jumpToNextFrame()) {
-            qDebug() << "[Error] QMovie:" << movie->lastErrorString();
-            this->stopAnimation();
-            return;
-        }
+        requestAnimationFrame(animationFrame + 1);
+    }
+}
+
+// frames are decoded in background; if it's not there yet we wait for onAnimationFrameReady()
+void ImageViewerV2::requestAnimationFrame(int number) {
+    animationTimer->stop();
+    AnimationFrame frame;
+    if(animation->takeFrame(number, frame)) {
+        pendingFrame = -1;
+        showDecodedFrame(frame);
+    } else {
+        pendingFrame = number;
+    }
+}
+
+void ImageViewerV2::onAnimationFrameReady(int number) {
+    if(!animation || number != pendingFrame)
+        return;
+    requestAnimationFrame(number);
+}
+
+void ImageViewerV2::onAnimationError() {
+    qDebug() << "[Error] AnimationDecoder: could not decode frame" << pendingFrame;
+    pendingFrame = -1;
+    stopAnimation();
+}
+
+void ImageViewerV2::showDecodedFrame(const AnimationFrame &frame) {
+    animationFrame = frame.number;
+    animationDelay = frame.delay;
+    emit frameChanged(animationFrame);
+    animationImage = frame.image;
+    if(animationTargetSize.isValid() && frame.scaled.size() == animationTargetSize) {
+        // pre-scaled by the decoder; pixmapItem keeps the old frame for geometry
+        pixmapScaled.reset(new QPixmap(QPixmap::fromImage(frame.scaled)));
+        pixmapScaled->setDevicePixelRatio(dpr);
+        pixmapItemScaled.setPixmap(*pixmapScaled);
+        pixmapItem.hide();
+        pixmapItemScaled.show();
+        updateMemoryCharges();
+    } else {
+        pixmapItemScaled.hide();
+        updatePixmap(std::unique_ptr<QPixmap>(new QPixmap(QPixmap::fromImage(frame.image))));
     }
-    emit frameChanged(movie->currentFrameNumber());
-    std::unique_ptr<QPixmap> newFrame(new QPixmap());
-    *newFrame = movie->currentPixmap();
-    updatePixmap(std::move(newFrame));
-    animationTimer->start(movie->nextFrameDelay());
+    if(animationRunning)
+        animationTimer->start(animationDelay);
 }
 
 void ImageViewerV2::nextFrame() {
-    if(!movie) {
+    if(!animation) {
         return;
-    } else if(movie->currentFrameNumber() == movie->frameCount() - 1) {
+    } else if(animationFrame == animation->frameCount() - 1) {
         showAnimationFrame(0);
     } else {
-        showAnimationFrame(movie->currentFrameNumber() + 1);
+        showAnimationFrame(animationFrame + 1);
     }
 }
 
 void ImageViewerV2::prevFrame() {
-    if(!movie) {
+    if(!animation) {
         return;
-    } else if(movie->currentFrameNumber() == 0) {
-        showAnimationFrame(movie->frameCount() - 1);
+    } else if(animationFrame == 0) {
+        showAnimationFrame(animation->frameCount() - 1);
     } else {
-        showAnimationFrame(movie->currentFrameNumber() - 1);
+        showAnimationFrame(animationFrame - 1);
     }
 }
 
 bool ImageViewerV2::showAnimationFrame(int frame) {
-    if(!movie || frame < 0 || frame >= movie->frameCount())
+    if(!animation || frame < 0)
         return false;
-    if(movie->currentFrameNumber() == frame)
+    int frameCount = animation->frameCount();
+    if(frameCount && frame >= frameCount)
+        return false;
+    if(animationFrame == frame && pendingFrame == -1)
         return true;
-    // at the first glance this may seem retarded
-    // because it is
-    // unfortunately i dont see a *better* way to do seeking with QMovie
-    // QMovie::CacheAll is buggy and memory inefficient
-    if(frame < movie->currentFrameNumber())
-        movie->jumpToFrame(0);
-    while(frame != movie->currentFrameNumber()) {
-        if(!movie->jumpToNextFrame()) {
-            qDebug() << "[Error] QMovie:" << movie->lastErrorString();
-            break;
-        }
-    }
-    emit frameChanged(movie->currentFrameNumber());
-    std::unique_ptr<QPixmap> newFrame(new QPixmap());
-    *newFrame = movie->currentPixmap();
-    updatePixmap(std::move(newFrame));
+    requestAnimationFrame(frame);
     return true;
 }
 
@@ -239,19 +275,26 @@ void ImageViewerV2::updatePixmap(std::unique_ptr<QPixmap> newPixmap) {
     pixmapItem.setPixmap(*pixmap);
     pixmapItem.show();
     pixmapItem.update();
+    updateMemoryCharges();
 }
 
 void ImageViewerV2::showAnimation(std::shared_ptr<QMovie> _movie) {
     if(_movie && _movie->isValid()) {
         reset();
-        movie = _movie;
-        movie->jumpToFrame(0);
+        // the first frame is already there from loading
+        std::unique_ptr<QPixmap> newFrame(new QPixmap(_movie->currentPixmap()));
+        animationFrame = 0;
+        animationDelay = qMax(_movie->nextFrameDelay(), 0);
+        animationImage = _movie->currentImage();
+        animation.reset(new AnimationDecoder(_movie));
+        connect(animation.get(), &AnimationDecoder::frameReady, this, &ImageViewerV2::onAnimationFrameReady);
+        connect(animation.get(), &AnimationDecoder::decodingFailed, this, &ImageViewerV2::onAnimationError);
         Qt::TransformationMode mode = smoothAnimatedImages ? Qt::SmoothTransformation : Qt::FastTransformation;
         pixmapItem.setTransformationMode(mode);
-        std::unique_ptr<QPixmap> newFrame(new QPixmap());
-        *newFrame = movie->currentPixmap();
         updatePixmap(std::move(newFrame));
-        emit durationChanged(movie->frameCount());
+        // frames come pre-scaled, so the first paint is final
+        firstPaintPending = true;
+        emit durationChanged(animation->frameCount());
         emit frameChanged(0);
 
         updateMinScale();
@@ -283,6 +326,7 @@ void ImageViewerV2::showImage(std::unique_ptr<QPixmap> _pixmap) {
             mode = Qt::FastTransformation;
         pixmapItem.setTransformationMode(mode);
         pixmapItem.show();
+        updateMemoryCharges();
         updateMinScale();
 
         if(!keepFitMode || imageFitMode == FIT_FREE)
@@ -297,6 +341,7 @@ void ImageViewerV2::showImage(std::unique_ptr<QPixmap> _pixmap) {
                 applySavedViewportPos();
         }
         requestScaling();
+        firstPaintPending = true;
         update();
     }
 }
@@ -311,7 +356,12 @@ void ImageViewerV2::reset() {
     pixmapItem.setOffset(10000,10000);
     pixmap.reset();
     stopAnimation();
-    movie = nullptr;
+    animation.reset();
+    animationImage = QImage();
+    animationTargetSize = QSize();
+    pendingFrame = -1;
+    firstPaintPending = finalPaintPending = scalePending = false;
+    updateMemoryCharges();
     centerOn(sceneRect().center());
     // when this view is not in focus this it won't update the background
     // so we force it here
@@ -322,8 +372,13 @@ void ImageViewerV2::closeImage() {
     reset();
 }
 
+void ImageViewerV2::updateMemoryCharges() {
+    pixmapCharge.set(pixmap ? MemoryMetrics::bytesOf(*pixmap) : 0);
+    scaledCharge.set(pixmapScaled ? MemoryMetrics::bytesOf(*pixmapScaled) : 0);
+}
+
 void ImageViewerV2::setScaledPixmap(std::unique_ptr<QPixmap> newFrame) {
-    if(!movie && newFrame->size() != scaledSizeR() * dpr)
+    if(!animation && newFrame->size() != scaledSizeR() * dpr)
         return;
 
     pixmapScaled = std::move(newFrame);
@@ -331,6 +386,11 @@ void ImageViewerV2::setScaledPixmap(std::unique_ptr<QPixmap> newFrame) {
     pixmapItemScaled.setPixmap(*pixmapScaled);
     pixmapItem.hide();
     pixmapItemScaled.show();
+    updateMemoryCharges();
+    if(scalePending) {
+        scalePending = false;
+        finalPaintPending = true;
+    }
 }
 
 bool ImageViewerV2::isDisplaying() const {
@@ -370,7 +430,7 @@ void ImageViewerV2::setScalingFilter(ScalingFilter filter) {
 }
 
 void ImageViewerV2::setLoopPlayback(bool mode) {
-    if(movie && mode && loopPlayback != mode)
+    if(animation && mode && loopPlayback != mode)
         startAnimation();
     loopPlayback = mode;
 }
@@ -397,7 +457,7 @@ Qt::TransformationMode ImageViewerV2::selectTransformationMode() {
     Qt::TransformationMode mode = Qt::SmoothTransformation;
     if(forceFastScale) {
         mode = Qt::FastTransformation;
-    } else if(movie) {
+    } else if(animation) {
         if(!smoothAnimatedImages || (pixmapItem.scale() > 1.0f && !smoothUpscaling))
             mode = Qt::FastTransformation;
     } else {
@@ -426,14 +486,30 @@ void ImageViewerV2::hide() {
 }
 
 void ImageViewerV2::requestScaling() {
-    if(!pixmap || pixmapItem.scale() == 1.0f || (!smoothUpscaling && pixmapItem.scale() >= 1.0f) || movie)
+    if(!pixmap)
+        return;
+    if(animation) {
+        updateAnimationTarget();
+        return;
+    }
+    if(pixmapItem.scale() == 1.0f || (!smoothUpscaling && pixmapItem.scale() >= 1.0f))
         return;
     if(scaleTimer->isActive())
         scaleTimer->stop();
     // request "real" scaling when graphicsscene scaling is insufficient
     // (it uses a single pass bilinear which is sharp but produces artifacts on low zoom levels)
-    if(currentScale() < FAST_SCALE_THRESHOLD)
+    if(currentScale() < FAST_SCALE_THRESHOLD) {
+        scalePending = true;
         emit scalingRequested(scaledSizeR() * dpr, mScalingFilter);
+    }
+}
+
+// animation frames are downscaled by the decoder thread, with the fast filter
+void ImageViewerV2::updateAnimationTarget() {
+    animationTargetSize = QSize();
+    if(currentScale() < FAST_SCALE_THRESHOLD)
+        animationTargetSize = scaledSizeR() * dpr;
+    animation->setTargetSize(animationTargetSize, smoothAnimatedImages ? QI_FILTER_BILINEAR : QI_FILTER_NEAREST);
 }
 
 bool ImageViewerV2::imageFits() const {
@@ -460,7 +536,7 @@ QWidget *ImageViewerV2::widget() {
 }
 
 bool ImageViewerV2::hasAnimation() const {
-    return (movie != nullptr);
+    return (animation != nullptr);
 }
 
 //  Right button zooming / dragging logic
@@ -650,6 +726,16 @@ void ImageViewerV2::showEvent(QShowEvent *event) {
         applyFitMode();
 }
 
+void ImageViewerV2::paintEvent(QPaintEvent *event) {
+    TRACE_SCOPE("ImageViewerV2::paint", "viewer");
+    QGraphicsView::paintEvent(event);
+    if(firstPaintPending)
+        navMetrics->firstPaint(!scalePending);
+    else if(finalPaintPending)
+        navMetrics->finalPaint();
+    firstPaintPending = finalPaintPending = false;
+}
+
 void ImageViewerV2::drawBackground(QPainter *painter, const QRectF &rect) {
     QGraphicsView::drawBackground(painter, rect);
     if(!isDisplaying() || !transparencyGrid || !pixmap->hasAlphaChannel())
@@ -968,10 +1054,14 @@ void ImageViewerV2::onScrollTimelineFinished() {
 void ImageViewerV2::swapToOriginalPixmap() {
     if(!pixmap || !pixmapItemScaled.isVisible())
         return;
+    // pixmapItem may still hold an older animation frame
+    if(animation && !animationImage.isNull())
+        updatePixmap(std::unique_ptr<QPixmap>(new QPixmap(QPixmap::fromImage(animationImage))));
     pixmapItemScaled.hide();
     pixmapItemScaled.setPixmap(QPixmap());
     pixmapScaled.reset(nullptr);
     pixmapItem.show();
+    updateMemoryCharges();
 }
 
 void ImageViewerV2::setZoomAnchor(QPoint viewportPos) {
@@ -1172,6 +1262,8 @@ void ImageViewerV2::doZoom(float newScale) {
     pixmapItem.setScale(newScale);
 
     pixmapItem.setTransformationMode(selectTransformationMode());
+    // scaled frames queued for the old zoom level are of no use now
+    animationTargetSize = QSize();
     swapToOriginalPixmap();
     emit scaleChanged(newScale);
 }
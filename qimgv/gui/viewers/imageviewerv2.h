@@ -14,6 +14,8 @@
 #include <memory>
 #include <cmath>
 #include "settings.h"
+#include "components/animationdecoder/animationdecoder.h"
+#include "components/metrics/memorymetrics.h"
 
 enum MouseInteractionState {
     MOUSE_NONE,
@@ -109,9 +111,12 @@ protected:
     void wheelEvent(QWheelEvent *event);
     void showEvent(QShowEvent *event);
     void drawBackground(QPainter *painter, const QRectF &rect);
+    void paintEvent(QPaintEvent *event);
 
 protected slots:
     void onAnimationTimer();
+    void onAnimationFrameReady(int number);
+    void onAnimationError();
 
 private slots:
     void requestScaling();
@@ -124,7 +129,14 @@ private:
     QGraphicsScene *scene;
     std::shared_ptr<QPixmap> pixmap;
     std::unique_ptr<QPixmap> pixmapScaled;
-    std::shared_ptr<QMovie> movie;
+    MemoryCharge pixmapCharge, scaledCharge;
+    std::unique_ptr<AnimationDecoder> animation;
+    int animationFrame, pendingFrame, animationDelay;
+    bool animationRunning;
+    // navigation metrics: next paints show a new image / its scaled version
+    bool firstPaintPending, finalPaintPending, scalePending;
+    QImage animationImage;     // full size current frame
+    QSize animationTargetSize; // size frames are pre-scaled to
     QGraphicsPixmapItem pixmapItem, pixmapItemScaled;
     QTimer *animationTimer, *scaleTimer;
     QScrollBar *hs, *vs;
@@ -171,6 +183,7 @@ private:
     void mousePan(QMouseEvent *event);
     void mouseMoveZoom(QMouseEvent *event);
     void reset();
+    void updateMemoryCharges();
     void applyFitMode();
 
     QTimeLine *scrollTimeLineX, *scrollTimeLineY;
@@ -181,6 +194,9 @@ private:
     void swapToOriginalPixmap();
     void setZoomAnchor(QPoint viewportPos);
     void updatePixmap(std::unique_ptr<QPixmap> newPixmap);
+    void requestAnimationFrame(int number);
+    void showDecodedFrame(const AnimationFrame &frame);
+    void updateAnimationTarget();
     Qt::TransformationMode selectTransformationMode();
     void centerIfNecessary();
     void snapToEdges();
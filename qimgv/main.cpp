@@ -6,9 +6,12 @@
 #include "appversion.h"
 #include "settings.h"
 #include "components/actionmanager/actionmanager.h"
+#include "components/metrics/memorymetrics.h"
+#include "components/metrics/navigationmetrics.h"
 #include "utils/inputmap.h"
 #include "utils/actions.h"
 #include "utils/cmdoptionsrunner.h"
+#include "utils/tracer.h"
 #include "sharedresources.h"
 #include "proxystyle.h"
 #include "core.h"
@@ -116,6 +119,7 @@ int main(int argc, char *argv[]) {
     inputMap = InputMap::getInstance();
     appActions = Actions::getInstance();
     settings = Settings::getInstance();
+    navMetrics = NavigationMetrics::getInstance();
     scriptManager = ScriptManager::getInstance();
     actionManager = ActionManager::getInstance();
     shrRes = SharedResources::getInstance();
@@ -140,9 +144,31 @@ int main(int argc, char *argv[]) {
             QCoreApplication::translate("main", "thumbnail-size")},
         {"build-options",
             QCoreApplication::translate("main", "Show build options.")},
+        {"mem-report",
+            QCoreApplication::translate("main", "Print memory use per subsystem on exit.")},
+        {"mem-log",
+            QCoreApplication::translate("main", "Log memory use per subsystem periodically."),
+            QCoreApplication::translate("main", "seconds")},
     });
+#ifdef USE_TRACING
+    parser.addOption({"trace",
+            QCoreApplication::translate("main", "Record timing spans into a Chrome trace file (chrome://tracing, ui.perfetto.dev)."),
+            QCoreApplication::translate("main", "file")});
+#endif
     parser.process(a);
 
+#ifdef USE_TRACING
+    if(parser.isSet("trace")) {
+        Tracer::start(parser.value("trace"));
+        QObject::connect(&a, &QCoreApplication::aboutToQuit, &Tracer::finish);
+    }
+#endif
+
+    if(parser.isSet("mem-report"))
+        QObject::connect(&a, &QCoreApplication::aboutToQuit, &MemoryMetrics::dump);
+    if(parser.isSet("mem-log"))
+        MemoryMetrics::startLog(parser.value("mem-log").toInt());
+
     if(parser.isSet("build-options")) {
         CmdOptionsRunner r;
         QTimer::singleShot(0, &r, &CmdOptionsRunner::showBuildOptions);
@@ -176,5 +202,6 @@ int main(int argc, char *argv[]) {
     qApp->processEvents();
 
     core.showGui();
+    QObject::connect(&a, &QCoreApplication::aboutToQuit, navMetrics, &NavigationMetrics::dump);
     return a.exec();
 }
@@ -33,10 +33,40 @@ Settings *Settings::getInstance() {
         settings = new Settings();
         settings->setupCache();
         settings->loadTheme();
+        settings->updateSnapshot();
     }
     return settings;
 }
 //------------------------------------------------------------------------------
+std::shared_ptr<const SettingsSnapshot> Settings::snapshot() const {
+    return std::atomic_load(&mSnapshot);
+}
+//------------------------------------------------------------------------------
+// readers holding the old one keep it alive until they're done
+void Settings::updateSnapshot() {
+    auto snap = std::make_shared<SettingsSnapshot>();
+    snap->smoothUpscaling = smoothUpscaling();
+    snap->smoothAnimatedImages = smoothAnimatedImages();
+    snap->usePreloader = usePreloader();
+    snap->useThumbnailCache = useThumbnailCache();
+    snap->unloadThumbs = unloadThumbs();
+    snap->sortFolders = sortFolders();
+    snap->jxlAnimation = jxlAnimation();
+    snap->videoPlayback = videoPlayback();
+    snap->memoryAllocationLimit = memoryAllocationLimit();
+    snap->scalingFilter = scalingFilter();
+    snap->supportedFormats = supportedFormats();
+    snap->videoFormats = mVideoFormatsMap;
+    QString filter;
+    filter.append(".*\\.(");
+    for(int i = 0; i < snap->supportedFormats.count(); i++)
+        filter.append(QString(snap->supportedFormats.at(i)) + "|");
+    filter.chop(1);
+    filter.append(")$");
+    snap->supportedFormatsRegex = filter;
+    std::atomic_store(&mSnapshot, std::shared_ptr<const SettingsSnapshot>(std::move(snap)));
+}
+//------------------------------------------------------------------------------
 void Settings::setupCache() {
 #if defined(__linux__) ||  defined(__FreeBSD__)
     QString genericCacheLocation = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
@@ -331,14 +361,7 @@ QString Settings::supportedFormatsFilter() {
 }
 //------------------------------------------------------------------------------
 QString Settings::supportedFormatsRegex() {
-    QString filter;
-    QList<QByteArray> formats = supportedFormats();
-    filter.append(".*\\.(");
-    for(int i = 0; i < formats.count(); i++)
-        filter.append(QString(formats.at(i)) + "|");
-    filter.chop(1);
-    filter.append(")$");
-    return filter;
+    return snapshot()->supportedFormatsRegex;
 }
 //------------------------------------------------------------------------------
 // returns list of mime types
@@ -632,6 +655,7 @@ void Settings::setLoopSlideshow(bool mode) {
 }
 //------------------------------------------------------------------------------
 void Settings::sendChangeNotification() {
+    updateSnapshot();
     emit settingsChanged();
 }
 //------------------------------------------------------------------------------
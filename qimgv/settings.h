@@ -16,6 +16,7 @@
 #include <QFontMetrics>
 #include <QVersionNumber>
 #include <QThread>
+#include <memory>
 #include "utils/script.h"
 #include "themestore.h"
 
@@ -95,12 +96,33 @@ enum ThumbPanelStyle {
     TH_PANEL_EXTENDED
 };
 
+// Values read on hot paths (and from worker threads).
+// Rebuilt on every settingsChanged(); never modified after publishing.
+struct SettingsSnapshot {
+    bool smoothUpscaling = true;
+    bool smoothAnimatedImages = true;
+    bool usePreloader = true;
+    bool useThumbnailCache = true;
+    bool unloadThumbs = true;
+    bool sortFolders = true;
+    bool jxlAnimation = false;
+    bool videoPlayback = false;
+    int memoryAllocationLimit = 1024;
+    ScalingFilter scalingFilter = QI_FILTER_BILINEAR;
+    QList<QByteArray> supportedFormats;
+    QString supportedFormatsRegex;
+    QMultiMap<QByteArray, QByteArray> videoFormats; // [mimetype, format]
+};
+
 class Settings : public QObject
 {
     Q_OBJECT
 public:
     static Settings* getInstance();
     ~Settings();
+    // lock-free, from any thread
+    std::shared_ptr<const SettingsSnapshot> snapshot() const;
+    void updateSnapshot();
     QStringList supportedMimeTypes();
     QList<QByteArray> supportedFormats();
     QString supportedFormatsFilter();
@@ -304,6 +326,7 @@ private:
     QDir *mTmpDir, *mThumbCacheDir, *mConfDir;
     ColorScheme mColorScheme;
     QMultiMap<QByteArray, QByteArray> mVideoFormatsMap; // [mimetype, format]
+    std::shared_ptr<const SettingsSnapshot> mSnapshot;
     void loadTheme();
     void saveTheme();
     void createColorVariants();
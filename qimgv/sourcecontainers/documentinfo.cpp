@@ -1,7 +1,13 @@
 #include "documentinfo.h"
+#include "utils/tracer.h"
 
-DocumentInfo::DocumentInfo(QString path)
-    : mDocumentType(DocumentType::NONE),
+// Everything needed for format / animation / orientation detection
+// is expected to be within this many bytes from the start.
+#define HEADER_SIZE 65536
+
+DocumentInfo::DocumentInfo(QString path, FileContents contents)
+    : mData(contents.data),
+      mDocumentType(DocumentType::NONE),
       mOrientation(0),
       mFormat(""),
       exifLoaded(false)
@@ -11,6 +17,9 @@ DocumentInfo::DocumentInfo(QString path)
         qDebug() << "FileInfo: cannot open: " << path;
         return;
     }
+    // file changed since it was read
+    if(!mData.isEmpty() && (mData.size() != fileInfo.size() || contents.lastModified != fileInfo.lastModified()))
+        mData.clear();
     detectFormat();
 }
 
@@ -68,21 +77,80 @@ int DocumentInfo::exifOrientation() const {
     return mOrientation;
 }
 
+QIODevice *DocumentInfo::device() {
+    if(!mFile) {
+        if(!mData.isEmpty()) {
+            auto buffer = new QBuffer();
+            buffer->setData(mData);
+            mFile.reset(buffer);
+        } else {
+            mFile.reset(new QFile(fileInfo.filePath()));
+        }
+        if(!mFile->open(QIODevice::ReadOnly)) {
+            qDebug() << "FileInfo: cannot open: " << fileInfo.filePath();
+            mFile.reset();
+            return nullptr;
+        }
+    }
+    mFile->seek(0);
+    return mFile.get();
+}
+
+std::unique_ptr<QIODevice> DocumentInfo::takeDevice() {
+    device();
+    mData.clear();
+    return std::move(mFile);
+}
+
+void DocumentInfo::closeDevice() {
+    mFile.reset();
+    // decoded; no need to keep the contents around
+    mData.clear();
+}
+
 // ##############################################################
 // ####################### PRIVATE METHODS ######################
 // ##############################################################
+// Checks the most common signatures directly
+// so QMimeDatabase only runs its full magic matching on the rest.
+static QString sniffMimeType(const QByteArray &header) {
+    if(header.startsWith("\xFF\xD8\xFF"))
+        return "image/jpeg";
+    if(header.startsWith("\x89PNG\r\n\x1A\n"))
+        return "image/png";
+    if(header.startsWith("GIF87a") || header.startsWith("GIF89a"))
+        return "image/gif";
+    if(header.startsWith("RIFF") && header.mid(8, 4) == "WEBP")
+        return "image/webp";
+    if(header.startsWith("\xFF\x0A") || header.startsWith(QByteArray("\x00\x00\x00\x0CJXL \r\n\x87\n", 12)))
+        return "image/jxl";
+    if(header.mid(4, 8) == "ftypavif" || header.mid(4, 8) == "ftypavis")
+        return "image/avif";
+    return "";
+}
+
 void DocumentInfo::detectFormat() {
     if(mDocumentType != DocumentType::NONE)
         return;
+    TRACE_SCOPE("DocumentInfo::detectFormat", "loader");
+    // the only read needed for detection
+    QByteArray header;
+    if(device())
+        header = mFile->read(HEADER_SIZE);
     QMimeDatabase mimeDb;
-    mMimeType = mimeDb.mimeTypeForFile(fileInfo.filePath(), QMimeDatabase::MatchContent);
+    QString sniffedType = sniffMimeType(header);
+    if(!sniffedType.isEmpty())
+        mMimeType = mimeDb.mimeTypeForName(sniffedType);
+    if(!mMimeType.isValid())
+        mMimeType = mimeDb.mimeTypeForData(header);
     auto mimeName = mMimeType.name().toUtf8();
     auto suffix = fileInfo.suffix().toLower().toUtf8();
+    auto conf = settings->snapshot();
     if(mimeName == "image/jpeg") {
         mFormat = "jpg";
         mDocumentType = DocumentType::STATIC;
     } else if(mimeName == "image/png") {
-        if(QImageReader::supportedImageFormats().contains("apng") && detectAPNG()) {
+        if(QImageReader::supportedImageFormats().contains("apng") && detectAPNG(header)) {
             mFormat = "apng";
             mDocumentType = DocumentType::ANIMATED;
         } else {
@@ -94,94 +162,62 @@ void DocumentInfo::detectFormat() {
         mDocumentType = DocumentType::ANIMATED;
     } else if(mimeName == "image/webp" || (mimeName == "audio/x-riff" && suffix == "webp")) {
         mFormat = "webp";
-        mDocumentType = detectAnimatedWebP() ? DocumentType::ANIMATED : DocumentType::STATIC;
+        mDocumentType = detectAnimatedWebP(header) ? DocumentType::ANIMATED : DocumentType::STATIC;
     } else if(mimeName == "image/jxl") {
         mFormat = "jxl";
         mDocumentType = detectAnimatedJxl() ? DocumentType::ANIMATED : DocumentType::STATIC;
-        if(mDocumentType == DocumentType::ANIMATED && !settings->jxlAnimation()) {
+        if(mDocumentType == DocumentType::ANIMATED && !conf->jxlAnimation) {
             mDocumentType = DocumentType::NONE;
             qDebug() << "animated jxl is off; skipping file";
         }
     } else if(mimeName == "image/avif") {
         mFormat = "avif";
-        mDocumentType = detectAnimatedAvif() ? DocumentType::ANIMATED : DocumentType::STATIC;
+        mDocumentType = detectAnimatedAvif(header) ? DocumentType::ANIMATED : DocumentType::STATIC;
     } else if(mimeName == "image/bmp") {
         mFormat = "bmp";
         mDocumentType = DocumentType::STATIC;
-    } else if(settings->videoPlayback() && settings->videoFormats().contains(mimeName)) {
+    } else if(conf->videoPlayback && conf->videoFormats.contains(mimeName)) {
         mDocumentType = DocumentType::VIDEO;
-        mFormat = settings->videoFormats().value(mimeName);
+        mFormat = conf->videoFormats.value(mimeName);
     } else {
         // just try to open via suffix if all of the above fails
         mFormat = suffix;
         if(mFormat.compare("jfif", Qt::CaseInsensitive) == 0)
             mFormat = "jpg";
-        if(settings->videoPlayback() && settings->videoFormats().values().contains(suffix))
+        if(conf->videoPlayback && conf->videoFormats.values().contains(suffix))
             mDocumentType = DocumentType::VIDEO;
         else
             mDocumentType = DocumentType::STATIC;
     }
-    loadExifOrientation();
+    loadExifOrientation(header);
+    // nothing else is going to read it
+    if(mDocumentType == DocumentType::VIDEO || mDocumentType == DocumentType::NONE)
+        closeDevice();
 }
 
-inline
 // dumb apng detector
-bool DocumentInfo::detectAPNG() {
-    QFile f(fileInfo.filePath());
-    if(f.open(QFile::ReadOnly)) {
-        QDataStream in(&f);
-        const int len = 120;
-        QByteArray qbuf("\0", len);
-        if (in.readRawData(qbuf.data(), len) > 0) {
-            return qbuf.contains("acTL");
-        }
-    }
-    return false;
+// acTL is required to come before the first IDAT
+bool DocumentInfo::detectAPNG(const QByteArray &header) {
+    int idat = header.indexOf("IDAT");
+    return header.left(idat == -1 ? header.size() : idat).contains("acTL");
 }
 
-bool DocumentInfo::detectAnimatedWebP() {
-    QFile f(fileInfo.filePath());
-    bool result = false;
-    if(f.open(QFile::ReadOnly)) {
-        QDataStream in(&f);
-        in.skipRawData(12);
-        char *buf = static_cast<char*>(malloc(5));
-        buf[4] = '\0';
-        in.readRawData(buf, 4);
-        if(strcmp(buf, "VP8X") == 0) {
-            in.skipRawData(4);
-            char flags;
-            in.readRawData(&flags, 1);
-            if(flags & (1 << 1)) {
-                result = true;
-            }
-        }
-        free(buf);
-    }
-    return result;
+bool DocumentInfo::detectAnimatedWebP(const QByteArray &header) {
+    // extended format header with the animation flag set
+    return header.size() > 20 && header.mid(12, 4) == "VP8X" && (header.at(20) & (1 << 1));
 }
 
-// TODO avoid creating multiple QImageReader instances
+// jxl needs the plugin to tell
 bool DocumentInfo::detectAnimatedJxl() {
-    QImageReader r(fileInfo.filePath(), "jxl");
+    QIODevice *dev = device();
+    if(!dev)
+        return false;
+    QImageReader r(dev, "jxl");
     return r.supportsAnimation();
 }
 
-bool DocumentInfo::detectAnimatedAvif() {
-    QFile f(fileInfo.filePath());
-    bool result = false;
-    if(f.open(QFile::ReadOnly)) {
-        QDataStream in(&f);
-        in.skipRawData(4); // skip box size
-        char *buf = static_cast<char*>(malloc(9));
-        buf[8] = '\0';
-        in.readRawData(buf, 8);
-        if(strcmp(buf, "ftypavis") == 0) {
-            result = true;
-        }
-        free(buf);
-    }
-    return result;
+bool DocumentInfo::detectAnimatedAvif(const QByteArray &header) {
+    return header.mid(4, 8) == "ftypavis";
 }
 
 void DocumentInfo::loadExifTags() {
@@ -297,18 +333,90 @@ QMap<QString, QString> DocumentInfo::getExifTags() {
     return exifTags;
 }
 
-void DocumentInfo::loadExifOrientation() {
-    if(mDocumentType == DocumentType::VIDEO || mDocumentType == DocumentType::NONE)
-        return;
+static inline quint16 readUInt16(const uchar *data, bool bigEndian) {
+    return bigEndian ? quint16((data[0] << 8) | data[1])
+                     : quint16((data[1] << 8) | data[0]);
+}
+
+static inline quint32 readUInt32(const uchar *data, bool bigEndian) {
+    return bigEndian ? (quint32(readUInt16(data, true)) << 16) | readUInt16(data + 2, true)
+                     : (quint32(readUInt16(data + 2, false)) << 16) | readUInt16(data, false);
+}
 
-    QString path = filePath();
-    QImageReader *reader = nullptr;
-    if(!mFormat.isEmpty())
-        reader = new QImageReader(path, mFormat.toStdString().c_str());
-    else
-        reader = new QImageReader(path);
+// same mapping as qt's jpeg plugin
+static int exifToTransformation(int exifOrientation) {
+    switch(exifOrientation) {
+        case 2: return QImageIOHandler::TransformationMirror;
+        case 3: return QImageIOHandler::TransformationRotate180;
+        case 4: return QImageIOHandler::TransformationFlip;
+        case 5: return QImageIOHandler::TransformationFlipAndRotate90;
+        case 6: return QImageIOHandler::TransformationRotate90;
+        case 7: return QImageIOHandler::TransformationMirrorAndRotate90;
+        case 8: return QImageIOHandler::TransformationRotate270;
+        default: return QImageIOHandler::TransformationNone;
+    }
+}
+
+// Reads the orientation tag from the jpeg exif block.
+// Returns false if the header ends before image data (can't tell).
+static bool readJpegOrientation(const QByteArray &header, int &orientation) {
+    const uchar *data = reinterpret_cast<const uchar*>(header.constData());
+    const int size = header.size();
+    int pos = 2; // skip SOI
+    while(pos + 4 <= size) {
+        if(data[pos] != 0xFF)
+            return false;
+        uchar marker = data[pos + 1];
+        if(marker == 0xFF) { // fill byte
+            pos++;
+            continue;
+        }
+        if(marker == 0xDA || marker == 0xD9) { // image data / end; no exif
+            orientation = QImageIOHandler::TransformationNone;
+            return true;
+        }
+        int segmentLength = readUInt16(data + pos + 2, true);
+        int segment = pos + 4;
+        int segmentEnd = pos + 2 + segmentLength;
+        if(marker == 0xE1 && segmentEnd <= size && segmentLength >= 8 &&
+           memcmp(data + segment, "Exif\0\0", 6) == 0)
+        {
+            const uchar *tiff = data + segment + 6;
+            const int tiffSize = segmentEnd - segment - 6;
+            if(tiffSize < 8 || (memcmp(tiff, "MM", 2) != 0 && memcmp(tiff, "II", 2) != 0))
+                return false;
+            bool bigEndian = (tiff[0] == 'M');
+            quint32 ifd = readUInt32(tiff + 4, bigEndian);
+            if(ifd + 2 > quint32(tiffSize))
+                return false;
+            int count = readUInt16(tiff + ifd, bigEndian);
+            for(int i = 0; i < count; i++) {
+                quint32 entry = ifd + 2 + i * 12;
+                if(entry + 12 > quint32(tiffSize))
+                    break;
+                if(readUInt16(tiff + entry, bigEndian) == 0x0112) {
+                    orientation = exifToTransformation(readUInt16(tiff + entry + 8, bigEndian));
+                    return true;
+                }
+            }
+            orientation = QImageIOHandler::TransformationNone;
+            return true;
+        }
+        pos = segmentEnd;
+    }
+    return false;
+}
 
-    if(reader->canRead())
-        mOrientation = static_cast<int>(reader->transformation());
-    delete reader;
+void DocumentInfo::loadExifOrientation(const QByteArray &header) {
+    if(mDocumentType == DocumentType::VIDEO || mDocumentType == DocumentType::NONE)
+        return;
+    // fast path: parse it ourselves
+    if(header.startsWith("\xFF\xD8\xFF") && readJpegOrientation(header, mOrientation))
+        return;
+    QIODevice *dev = device();
+    if(!dev)
+        return;
+    QImageReader reader(dev, mFormat.toLatin1());
+    if(reader.canRead())
+        mOrientation = static_cast<int>(reader.transformation());
 }
@@ -7,10 +7,14 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QDateTime>
+#include <QFile>
+#include <QBuffer>
+#include <memory>
 #include <cmath>
 #include <cstring>
 #include "utils/stuff.h"
 #include "settings.h"
+#include "sourcecontainers/filecontents.h"
 
 #ifdef USE_EXIV2
 
@@ -27,7 +31,8 @@ enum DocumentType { NONE, STATIC, ANIMATED, VIDEO };
 
 class DocumentInfo {
 public:
-    DocumentInfo(QString path);
+    // contents: if already in memory
+    DocumentInfo(QString path, FileContents contents = FileContents());
     ~DocumentInfo();
     
     QString directoryPath() const;
@@ -47,8 +52,19 @@ public:
     void loadExifTags();
     QMap<QString, QString> getExifTags();
 
+    // The file opened during detection, rewound to the start.
+    // Decoders should read from it instead of opening the file again.
+    // A buffer over the contents if those were passed in.
+    // Reopens the file if it was closed. nullptr on error.
+    QIODevice *device();
+    // same, but the caller takes ownership
+    std::unique_ptr<QIODevice> takeDevice();
+    void closeDevice();
+
 private:
     QFileInfo fileInfo;
+    std::unique_ptr<QIODevice> mFile;
+    QByteArray mData;
     DocumentType mDocumentType;
     int mOrientation;
     QString mFormat;
@@ -57,11 +73,11 @@ private:
     // guesses file type from its contents
     // and sets extension
     void detectFormat();
-    void loadExifOrientation();
-    bool detectAPNG();
-    bool detectAnimatedWebP();
+    void loadExifOrientation(const QByteArray &header);
+    bool detectAPNG(const QByteArray &header);
+    bool detectAnimatedWebP(const QByteArray &header);
     bool detectAnimatedJxl();
-    bool detectAnimatedAvif();
+    bool detectAnimatedAvif(const QByteArray &header);
     QMap<QString, QString> exifTags;
     QMimeType mMimeType;
 };
@@ -0,0 +1,15 @@
+#pragma once
+#include <QByteArray>
+#include <QDateTime>
+
+// File contents read ahead of decoding.
+// lastModified is taken before reading; if the file has a different one
+// by the time it is decoded the contents are stale.
+struct FileContents {
+    QByteArray data;
+    QDateTime lastModified;
+
+    bool isEmpty() const {
+        return data.isEmpty();
+    }
+};
@@ -47,3 +47,7 @@ FSEntry::FSEntry( QString _path, QString _name, bool _isDirectory)
 bool FSEntry::operator==(const QString &anotherPath) const {
     return this->path == anotherPath;
 }
+
+qint64 FSEntry::memoryBytes() const {
+    return sizeof(FSEntry) + (path.capacity() + name.capacity()) * sizeof(QChar);
+}
@@ -11,6 +11,8 @@ public:
     FSEntry( QString _path, QString _name, std::uintmax_t _size, bool _isDirectory);
     FSEntry( QString _path, QString _name, bool _isDirectory);
     bool operator==(const QString &anotherPath) const;
+    // approximate heap + inline size
+    qint64 memoryBytes() const;
 
     QString path, name;
     std::uintmax_t size;
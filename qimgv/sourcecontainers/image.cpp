@@ -23,6 +23,10 @@ QString Image::filePath() const {
     return mPath;
 }
 
+qint64 Image::memoryBytes() {
+    return 0;
+}
+
 bool Image::isLoaded() const {
     return mLoaded;
 }
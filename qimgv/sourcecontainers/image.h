@@ -29,6 +29,8 @@ public:
     qint64 fileSize() const;
     QDateTime lastModified() const;
     QMap<QString, QString> getExifTags();
+    // decoded data held by this image
+    virtual qint64 memoryBytes();
 
 protected:
     virtual void load() = 0;
@@ -1,4 +1,5 @@
 #include "imageanimated.h"
+#include "utils/tracer.h"
 #include <time.h>
 
 // TODO: this class is kinda useless now. redesign?
@@ -25,13 +26,18 @@ ImageAnimated::~ImageAnimated() {
 void ImageAnimated::load() {
     if(isLoaded())
         return;
+    TRACE_SCOPE("ImageAnimated::load", "decode");
     loadMovie();
     mLoaded = true;
 }
 
 void ImageAnimated::loadMovie() {
     movie.reset(new QMovie());
-    movie->setFileName(mPath);
+    // the movie may outlive this image, so it gets to own the file
+    QIODevice *device = mDocInfo->takeDevice().release();
+    if(device)
+        device->setParent(movie.get());
+    movie->setDevice(device);
     movie->setFormat(mDocInfo->format().toStdString().c_str());
     movie->jumpToFrame(0);
     mSize = movie->frameRect().size();
@@ -42,6 +48,10 @@ int ImageAnimated::frameCount() {
     return mFrameCount;
 }
 
+qint64 ImageAnimated::memoryBytes() {
+    return movie ? qint64(mSize.width()) * mSize.height() * 4 : 0;
+}
+
 // TODO: overwrite (self included)
 bool ImageAnimated::save(QString destPath) {
     QFile file(mPath);
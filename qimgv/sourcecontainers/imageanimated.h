@@ -21,6 +21,8 @@ public:
     bool isEdited();
 
     int frameCount();
+    // the movie's current frame; the rest is up to AnimationDecoder
+    qint64 memoryBytes();
 public slots:
     bool save();
     bool save(QString destPath);
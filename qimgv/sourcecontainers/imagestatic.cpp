@@ -1,5 +1,11 @@
 #include "imagestatic.h"
 #include <time.h>
+#include "components/cache/bufferpool.h"
+#include "components/metrics/memorymetrics.h"
+#include "utils/tracer.h"
+#ifdef USE_LIBJPEG_TURBO
+#include "utils/jpegdecoder.h"
+#endif
 
 ImageStatic::ImageStatic(QString _path)
     : Image(_path)
@@ -21,12 +27,41 @@ void ImageStatic::load() {
     if(isLoaded()) {
         return;
     }
+    TRACE_SCOPE("ImageStatic::load", "decode");
     if(mDocInfo->mimeType().name() == "image/vnd.microsoft.icon")
         loadICO();
+#ifdef USE_LIBJPEG_TURBO
+    else if(mDocInfo->format() == "jpg" && loadJPEG())
+        return;
+#endif
     else
         loadGeneric();
 }
 
+#ifdef USE_LIBJPEG_TURBO
+// Returns false for files JpegDecoder can't handle; those go through Qt.
+bool ImageStatic::loadJPEG() {
+    QIODevice *dev = mDocInfo->device();
+    if(!dev)
+        return false;
+    QByteArray data = dev->readAll();
+    QSize size;
+    QImage::Format format;
+    if(!JpegDecoder::readHeader(data, size, format))
+        return false;
+    // same limit QImageReader applies
+    if(qint64(size.width()) * size.height() * 4 > qint64(settings->snapshot()->memoryAllocationLimit) * 1024 * 1024)
+        return false;
+    std::unique_ptr<QImage> img(new QImage(BufferPool::createImage(size, format)));
+    if(!JpegDecoder::read(data, *img))
+        return false;
+    mDocInfo->closeDevice();
+    image = ImageLib::exifRotated(std::move(img), mDocInfo->exifOrientation());
+    mLoaded = true;
+    return true;
+}
+#endif
+
 
 void ImageStatic::loadGeneric() {
     /* QImageReader::read() seems more reliable than just reading via QImage.
@@ -37,12 +72,36 @@ void ImageStatic::loadGeneric() {
      *
      * tldr: qimage bad
      */
-    QImageReader r(mPath, mDocInfo->format().toStdString().c_str());
+    // read from the file DocumentInfo already has open
+    QImageReader r(mDocInfo->device(), mDocInfo->format().toLatin1());
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    r.setAllocationLimit(settings->memoryAllocationLimit());
+    r.setAllocationLimit(settings->snapshot()->memoryAllocationLimit);
 #endif
+    // Qt's handlers decode into the given image if size & format match,
+    // so give them one backed by a reused buffer.
+    // That skips the reader's allocation limit; createImage() checks it instead
+    // and returns a null image, leaving the allocation to read()
     QImage *tmp = new QImage();
-    r.read(tmp);
+    if(r.size().isValid() && r.imageFormat() != QImage::Format_Invalid)
+        *tmp = BufferPool::createImage(r.size(), r.imageFormat());
+    bool pooled = !tmp->isNull();
+    bool ok = r.read(tmp);
+    r.setDevice(nullptr);
+    // pooled memory is not cleared; whatever a failed decode left unwritten
+    // would show a previous image. Drop it and read again into a fresh one
+    if(!ok && pooled) {
+        *tmp = QImage();
+        QIODevice *dev = mDocInfo->device();
+        if(dev && dev->seek(0)) {
+            QImageReader retry(dev, mDocInfo->format().toLatin1());
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+            retry.setAllocationLimit(settings->snapshot()->memoryAllocationLimit);
+#endif
+            retry.read(tmp);
+            retry.setDevice(nullptr);
+        }
+    }
+    mDocInfo->closeDevice();
     std::unique_ptr<const QImage> img(tmp);
     img = ImageLib::exifRotated(std::move(img), mDocInfo.get()->exifOrientation());
     // scaling this format via qt results in transparent background
@@ -61,6 +120,7 @@ void ImageStatic::loadGeneric() {
 // TODO: move this out somewhere to use in other places
 void ImageStatic::loadICO() {
     // Big brain code. It's mostly for small ico files so whatever. I'm not patching Qt for this.
+    mDocInfo->closeDevice();
     QIcon icon(mPath);
     QList<QSize> sizes = icon.availableSizes();
     QSize maxSize(0, 0);
@@ -160,6 +220,15 @@ QSize ImageStatic::size() {
     return isEdited()?imageEdited->size():image->size();
 }
 
+qint64 ImageStatic::memoryBytes() {
+    qint64 bytes = 0;
+    if(image)
+        bytes += MemoryMetrics::bytesOf(*image);
+    if(imageEdited)
+        bytes += MemoryMetrics::bytesOf(*imageEdited);
+    return bytes;
+}
+
 bool ImageStatic::setEditedImage(std::unique_ptr<const QImage> imageEditedNew) {
     if(imageEditedNew && imageEditedNew->width() != 0) {
         discardEditedImage();
@@ -23,6 +23,8 @@ public:
     int width();
     QSize size();
 
+    qint64 memoryBytes();
+
     bool setEditedImage(std::unique_ptr<const QImage> imageEditedNew);
     bool discardEditedImage();
 
@@ -36,5 +38,8 @@ private:
     std::shared_ptr<const QImage> image, imageEdited;
     void loadGeneric();
     void loadICO();
+#ifdef USE_LIBJPEG_TURBO
+    bool loadJPEG();
+#endif
     QString generateHash(QString str);
 };
@@ -1,13 +1,19 @@
 #include "thumbnail.h"
+#include "gui/thumbnailatlas.h"
+#include <QApplication>
 
 Thumbnail::Thumbnail(QString _name, QString _info, int _size, std::shared_ptr<QPixmap> _pixmap)
     : mName(_name),
       mInfo(_info),
       mPixmap(_pixmap),
-      mSize(_size)
+      mSize(_size),
+      mHasAlphaChannel(false),
+      mCharge(MEM_THUMBNAILS)
 {
-    if(_pixmap)
+    if(_pixmap) {
         mHasAlphaChannel = _pixmap->hasAlphaChannel();
+        mCharge.set(MemoryMetrics::bytesOf(*_pixmap));
+    }
 }
 
 QString Thumbnail::name() {
@@ -29,3 +35,36 @@ bool Thumbnail::hasAlphaChannel() {
 std::shared_ptr<QPixmap> Thumbnail::pixmap() {
     return mPixmap;
 }
+
+void Thumbnail::moveToAtlas(ThumbnailAtlas &atlas) {
+    if(!mPixmap)
+        return;
+    auto slot = atlas.add(*mPixmap);
+    if(slot) {
+        mSlot = slot;
+        mPixmap.reset();
+        mCharge.set(0);
+    }
+}
+
+bool Thumbnail::inAtlas() {
+    return mSlot != nullptr;
+}
+
+const QPixmap *Thumbnail::texture() {
+    if(mSlot)
+        return mSlot->pixmap();
+    return mPixmap.get();
+}
+
+QRect Thumbnail::textureRect() {
+    if(mSlot)
+        return mSlot->rect();
+    if(mPixmap)
+        return mPixmap->rect();
+    return QRect();
+}
+
+QSize Thumbnail::textureSize() {
+    return textureRect().size() / qApp->devicePixelRatio();
+}
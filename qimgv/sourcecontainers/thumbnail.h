@@ -3,6 +3,10 @@
 #include <QString>
 #include <QPixmap>
 #include <memory>
+#include "components/metrics/memorymetrics.h"
+
+class ThumbnailAtlas;
+class AtlasSlot;
 
 class Thumbnail {
 public:
@@ -11,10 +15,21 @@ public:
     QString info();
     int size();
     bool hasAlphaChannel();
+    // null once moved into an atlas
     std::shared_ptr<QPixmap> pixmap();
+    // moves the pixmap into the atlas; keeps it if it does not fit
+    void moveToAtlas(ThumbnailAtlas &atlas);
+    bool inAtlas();
+    // what to draw: texture() at textureRect(); nullptr if there is no pixmap
+    const QPixmap *texture();
+    QRect textureRect();
+    // dpr-adjusted size
+    QSize textureSize();
 private:
     QString mName, mInfo;
     std::shared_ptr<QPixmap> mPixmap;
+    std::shared_ptr<AtlasSlot> mSlot;
     int mSize;
     bool mHasAlphaChannel;
+    MemoryCharge mCharge; // own pixmap; atlas pages are counted separately
 };
@@ -90,5 +90,6 @@ void Actions::init() {
     mActions.insert("print", QVersionNumber(1,0,0));
     mActions.insert("toggleFullscreenInfoBar", QVersionNumber(1,0,0));
     mActions.insert("pasteFile", QVersionNumber(1,0,3));
+    mActions.insert("toggleMetricsOverlay", QVersionNumber(1,0,3));
 }
 
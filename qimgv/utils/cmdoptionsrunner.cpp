@@ -45,6 +45,9 @@ void CmdOptionsRunner::showBuildOptions() {
 #endif
 #ifdef USE_OPENCV
     features << "USE_OPENCV";
+#endif
+#ifdef USE_TRACING
+    features << "USE_TRACING";
 #endif
     qDebug() << "\nEnabled build options:";
     if(!features.count())
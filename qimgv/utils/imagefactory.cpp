@@ -1,7 +1,9 @@
 #include "imagefactory.h"
+#include "utils/tracer.h"
 
-std::shared_ptr<Image> ImageFactory::createImage(QString path) {
-    std::unique_ptr<DocumentInfo> docInfo(new DocumentInfo(path));
+std::shared_ptr<Image> ImageFactory::createImage(QString path, FileContents contents) {
+    TRACE_SCOPE("ImageFactory::createImage", "loader");
+    std::unique_ptr<DocumentInfo> docInfo(new DocumentInfo(path, contents));
     std::shared_ptr<Image> img = nullptr;
     if(docInfo->type() == NONE) {
         qDebug() << "ImageFactory: cannot load " << docInfo->filePath();
@@ -9,5 +9,6 @@
 
 class ImageFactory {
 public:
-    static std::shared_ptr<Image> createImage(QString path);
+    // contents: if already in memory
+    static std::shared_ptr<Image> createImage(QString path, FileContents contents = FileContents());
 };
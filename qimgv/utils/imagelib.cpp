@@ -1,4 +1,129 @@
 #include "imagelib.h"
+#include <cstring>
+#include <QImageIOHandler>
+#include "components/cache/bufferpool.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// pixels are moved in TILE_SIZE squares so both source and
+// destination rows stay in cache during transposing
+#define TILE_SIZE 64
+
+namespace {
+
+template<int N>
+struct Pixel {
+    uchar b[N];
+};
+
+// Where a source pixel goes: dst + x * stepX + y * stepY (in bytes).
+struct OrientationMap {
+    qsizetype origin, stepX, stepY;
+};
+
+// Follows the order exifRotated() always used: mirror/flip first, then rotate.
+OrientationMap orientationMap(int orientation, int w, int h, qsizetype dstBpl, int bpp) {
+    // dest X = x0 + ax * x + ay * y;  dest Y = y0 + bx * x + by * y
+    qsizetype x0 = 0, y0 = 0, ax = 1, ay = 0, bx = 0, by = 1;
+    switch(orientation) {
+    case 1: x0 = w - 1; ax = -1; break;                                  // mirror
+    case 2: y0 = h - 1; by = -1; break;                                  // flip
+    case 3: x0 = w - 1; ax = -1; y0 = h - 1; by = -1; break;             // 180
+    case 4: x0 = h - 1; ax = 0; ay = -1; bx = 1; by = 0; break;          // 90
+    case 5: x0 = h - 1; ax = 0; ay = -1; y0 = w - 1; bx = -1; by = 0; break; // mirror + 90
+    case 6: ax = 0; ay = 1; bx = 1; by = 0; break;                       // transpose
+    case 7: ax = 0; ay = 1; y0 = w - 1; bx = -1; by = 0; break;          // 270
+    default: break;
+    }
+    return { y0 * dstBpl + x0 * bpp, bx * dstBpl + ax * bpp, by * dstBpl + ay * bpp };
+}
+
+template<typename P>
+void transformTile(const uchar *src, qsizetype srcBpl, uchar *dst, OrientationMap m,
+                   int tx, int ty, int tw, int th)
+{
+    for(int y = ty; y < ty + th; y++) {
+        auto s = reinterpret_cast<const P*>(src + y * srcBpl) + tx;
+        uchar *d = dst + m.origin + tx * m.stepX + y * m.stepY;
+        for(int x = 0; x < tw; x++, d += m.stepX)
+            *reinterpret_cast<P*>(d) = s[x];
+    }
+}
+
+#ifdef __SSE2__
+// 4x4 block transpose of 32bpp pixels; source columns become destination rows
+inline void transposeBlock4(const uchar *src, qsizetype srcBpl, uchar *d, qsizetype stepX, bool reversed) {
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + srcBpl));
+    __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * srcBpl));
+    __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * srcBpl));
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    __m128i c[4] = { _mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+                     _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3) };
+    for(int i = 0; i < 4; i++, d += stepX) {
+        __m128i v = reversed ? _mm_shuffle_epi32(c[i], _MM_SHUFFLE(0, 1, 2, 3)) : c[i];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d), v);
+    }
+}
+
+void transposeTile32(const uchar *src, qsizetype srcBpl, uchar *dst, OrientationMap m,
+                     int tx, int ty, int tw, int th)
+{
+    // here a source row lands in a destination column, and
+    // 4 consecutive source rows make 4 adjacent pixels (maybe right to left)
+    bool reversed = m.stepY < 0;
+    int tw4 = tw & ~3, th4 = th & ~3;
+    for(int y = ty; y < ty + th4; y += 4) {
+        for(int x = tx; x < tx + tw4; x += 4) {
+            uchar *d = dst + m.origin + x * m.stepX + (reversed ? y + 3 : y) * m.stepY;
+            transposeBlock4(src + y * srcBpl + x * 4, srcBpl, d, m.stepX, reversed);
+        }
+    }
+    if(tw4 < tw)
+        transformTile<quint32>(src, srcBpl, dst, m, tx + tw4, ty, tw - tw4, th);
+    if(th4 < th)
+        transformTile<quint32>(src, srcBpl, dst, m, tx, ty + th4, tw4, th - th4);
+}
+#endif
+
+template<typename P>
+void transformPixels(const QImage *src, QImage *dst, int orientation) {
+    int w = src->width(), h = src->height();
+    const uchar *s = src->constBits();
+    uchar *d = dst->bits();
+    qsizetype srcBpl = src->bytesPerLine();
+    OrientationMap m = orientationMap(orientation, w, h, dst->bytesPerLine(), sizeof(P));
+    if(orientation < 4) {
+        // rows stay rows
+        for(int y = 0; y < h; y++) {
+            if(m.stepX > 0)
+                memcpy(d + m.origin + y * m.stepY, s + y * srcBpl, w * sizeof(P));
+            else
+                transformTile<P>(s, srcBpl, d, m, 0, y, w, 1);
+        }
+        return;
+    }
+    for(int ty = 0; ty < h; ty += TILE_SIZE) {
+        int th = qMin(TILE_SIZE, h - ty);
+        for(int tx = 0; tx < w; tx += TILE_SIZE) {
+            int tw = qMin(TILE_SIZE, w - tx);
+#ifdef __SSE2__
+            if(sizeof(P) == 4) {
+                transposeTile32(s, srcBpl, d, m, tx, ty, tw, th);
+                continue;
+            }
+#endif
+            transformTile<P>(s, srcBpl, d, m, tx, ty, tw, th);
+        }
+    }
+}
+
+} // namespace
+
 
 void ImageLib::recolor(QPixmap &pixmap, QColor color) {
     QPainter p(&pixmap);
@@ -11,6 +136,13 @@ void ImageLib::recolor(QPixmap &pixmap, QColor color) {
 QImage *ImageLib::rotatedRaw(const QImage *src, int grad) {
     if(!src)
         return new QImage();
+    // right angles don't need resampling
+    switch((grad % 360 + 360) % 360) {
+    case 0:   return new QImage(*src);
+    case 90:  return orientedRaw(src, QImageIOHandler::TransformationRotate90);
+    case 180: return orientedRaw(src, QImageIOHandler::TransformationRotate180);
+    case 270: return orientedRaw(src, QImageIOHandler::TransformationRotate270);
+    }
     QImage *img = new QImage();
     QTransform transform;
     transform.rotate(grad);
@@ -40,7 +172,7 @@ QImage* ImageLib::flippedHRaw(const QImage *src) {
     if(!src)
         return new QImage();
     else
-        return new QImage(src->mirrored(true, false));
+        return orientedRaw(src, QImageIOHandler::TransformationMirror);
 }
 //------------------------------------------------------------------------------
 QImage* ImageLib::flippedH(std::shared_ptr<const QImage> src) {
@@ -51,74 +183,60 @@ QImage* ImageLib::flippedVRaw(const QImage *src) {
     if(!src)
         return new QImage();
     else
-        return new QImage(src->mirrored(false, true));
+        return orientedRaw(src, QImageIOHandler::TransformationFlip);
 }
 //------------------------------------------------------------------------------
 QImage* ImageLib::flippedV(std::shared_ptr<const QImage> src) {
     return flippedVRaw(src.get());
 }
 //------------------------------------------------------------------------------
-std::unique_ptr<const QImage> ImageLib::exifRotated(std::unique_ptr<const QImage> src, int orientation) {
-    switch(orientation) {
-    case 1: {
-        src.reset(ImageLib::flippedHRaw(src.get()));
-    } break;
-    case 2: {
-        src.reset(ImageLib::flippedVRaw(src.get()));
-    } break;
-    case 3: {
-        src.reset(ImageLib::flippedHRaw(src.get()));
-        src.reset(ImageLib::flippedVRaw(src.get()));
-    } break;
-    case 4: {
-        src.reset(ImageLib::rotatedRaw(src.get(), 90));
-    } break;
-    case 5: {
-        src.reset(ImageLib::flippedHRaw(src.get()));
-        src.reset(ImageLib::rotatedRaw(src.get(), 90));
-    } break;
-    case 6: {
-        src.reset(ImageLib::flippedVRaw(src.get()));
-        src.reset(ImageLib::rotatedRaw(src.get(), 90));
-    } break;
-    case 7: {
-        src.reset(ImageLib::rotatedRaw(src.get(), -90));
-    } break;
-    default: {
-    } break;
+QImage *ImageLib::orientedRaw(const QImage *src, int orientation) {
+    if(!src)
+        return new QImage();
+    if(orientation <= 0 || orientation > 7 || src->isNull())
+        return new QImage(*src);
+    int bpp = src->depth() / 8;
+    if(src->depth() % 8 || !(bpp == 1 || bpp == 2 || bpp == 3 || bpp == 4 || bpp == 8 || bpp == 16)) {
+        // packed formats (mono etc.)
+        QImage tmp = *src;
+        if(orientation == 1 || orientation == 3 || orientation == 5)
+            tmp = tmp.mirrored(true, false);
+        if(orientation == 2 || orientation == 3 || orientation == 6)
+            tmp = tmp.mirrored(false, true);
+        if(orientation >= 4)
+            tmp = tmp.transformed(QTransform().rotate(orientation == 7 ? -90 : 90));
+        return new QImage(tmp);
+    }
+    QSize size = (orientation < 4) ? src->size() : src->size().transposed();
+    QImage *dst = new QImage(BufferPool::createImage(size, src->format()));
+    if(dst->isNull())
+        return dst;
+    dst->setColorTable(src->colorTable());
+    dst->setDevicePixelRatio(src->devicePixelRatio());
+    dst->setDotsPerMeterX(orientation < 4 ? src->dotsPerMeterX() : src->dotsPerMeterY());
+    dst->setDotsPerMeterY(orientation < 4 ? src->dotsPerMeterY() : src->dotsPerMeterX());
+    for(auto &key : src->textKeys())
+        dst->setText(key, src->text(key));
+    switch(bpp) {
+    case 1:  transformPixels<Pixel<1>>(src, dst, orientation); break;
+    case 2:  transformPixels<Pixel<2>>(src, dst, orientation); break;
+    case 3:  transformPixels<Pixel<3>>(src, dst, orientation); break;
+    case 4:  transformPixels<quint32>(src, dst, orientation); break;
+    case 8:  transformPixels<Pixel<8>>(src, dst, orientation); break;
+    case 16: transformPixels<Pixel<16>>(src, dst, orientation); break;
     }
+    return dst;
+}
+//------------------------------------------------------------------------------
+std::unique_ptr<const QImage> ImageLib::exifRotated(std::unique_ptr<const QImage> src, int orientation) {
+    if(src && orientation > 0 && orientation <= 7)
+        src.reset(orientedRaw(src.get(), orientation));
     return src;
 }
 //------------------------------------------------------------------------------
 std::unique_ptr<QImage> ImageLib::exifRotated(std::unique_ptr<QImage> src, int orientation) {
-    switch(orientation) {
-    case 1: {
-        src.reset(ImageLib::flippedHRaw(src.get()));
-    } break;
-    case 2: {
-        src.reset(ImageLib::flippedVRaw(src.get()));
-    } break;
-    case 3: {
-        src.reset(ImageLib::flippedHRaw(src.get()));
-        src.reset(ImageLib::flippedVRaw(src.get()));
-    } break;
-    case 4: {
-        src.reset(ImageLib::rotatedRaw(src.get(), 90));
-    } break;
-    case 5: {
-        src.reset(ImageLib::flippedHRaw(src.get()));
-        src.reset(ImageLib::rotatedRaw(src.get(), 90));
-    } break;
-    case 6: {
-        src.reset(ImageLib::flippedVRaw(src.get()));
-        src.reset(ImageLib::rotatedRaw(src.get(), 90));
-    } break;
-    case 7: {
-        src.reset(ImageLib::rotatedRaw(src.get(), -90));
-    } break;
-    default: {
-    } break;
-    }
+    if(src && orientation > 0 && orientation <= 7)
+        src.reset(orientedRaw(src.get(), orientation));
     return src;
 }
 //------------------------------------------------------------------------------
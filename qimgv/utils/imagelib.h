@@ -28,6 +28,9 @@ class ImageLib {
         static QImage *flippedVRaw(const QImage *src);
         static QImage *flippedV(std::shared_ptr<const QImage> src);
 
+        // any of the 8 QImageIOHandler::Transformations, in a single pass
+        static QImage *orientedRaw(const QImage *src, int orientation);
+
         //static QImage *scaled(const QImage *source, QSize destSize, ScalingFilter filter);
         static QImage *scaled(std::shared_ptr<const QImage> source, QSize destSize, ScalingFilter filter);
 
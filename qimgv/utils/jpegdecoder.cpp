@@ -0,0 +1,418 @@
+#include "jpegdecoder.h"
+#include "utils/tracer.h"
+#include <QThreadPool>
+#include <QThread>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <memory>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <jpeglib.h>
+
+// not worth splitting below this
+#define PARALLEL_MIN_PIXELS (2 * 1024 * 1024)
+// more strips than threads, so an uneven split doesn't leave cores idle
+#define STRIPS_PER_THREAD   2
+// scanlines per jpeg_read_scanlines() call
+#define ROW_BATCH           16
+#define CROP_MARGIN         2
+
+namespace {
+
+struct ErrorManager {
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+void errorExit(j_common_ptr cinfo) {
+    longjmp(reinterpret_cast<ErrorManager*>(cinfo->err)->jump, 1);
+}
+
+// warnings about corrupt data are not fatal, same as in Qt
+void outputMessage(j_common_ptr) {
+}
+
+void setupErrors(jpeg_decompress_struct &cinfo, ErrorManager &err) {
+    cinfo.err = jpeg_std_error(&err.pub);
+    err.pub.error_exit = errorExit;
+    err.pub.output_message = outputMessage;
+}
+
+// Picks libjpeg output matching the QImage format byte for byte.
+bool setupOutput(jpeg_decompress_struct &cinfo, QImage::Format &format) {
+    switch(cinfo.jpeg_color_space) {
+    case JCS_GRAYSCALE:
+        cinfo.out_color_space = JCS_GRAYSCALE;
+        format = QImage::Format_Grayscale8;
+        break;
+    case JCS_YCbCr:
+    case JCS_RGB:
+        // 0xffRRGGBB; libjpeg-turbo fills X with 0xff
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        cinfo.out_color_space = JCS_EXT_BGRX;
+#else
+        cinfo.out_color_space = JCS_EXT_XRGB;
+#endif
+        format = QImage::Format_RGB32;
+        break;
+    default:
+        return false;
+    }
+    // same as Qt's default
+    cinfo.dct_method = JDCT_ISLOW;
+    return true;
+}
+
+// Decodes rows [skip, skip + rows) of a jpeg into dst; used for strips.
+bool decodeRows(const QByteArray &jpeg, uchar *dst, qsizetype bpl, int width, int skip, int rows) {
+    jpeg_decompress_struct cinfo;
+    ErrorManager err;
+    setupErrors(cinfo, err);
+    if(setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, reinterpret_cast<const unsigned char*>(jpeg.constData()), static_cast<unsigned long>(jpeg.size()));
+    QImage::Format format;
+    if(jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK || !setupOutput(cinfo, format)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_start_decompress(&cinfo);
+    if(static_cast<int>(cinfo.output_width) != width || static_cast<int>(cinfo.output_height) < skip + rows) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    if(skip)
+        jpeg_skip_scanlines(&cinfo, static_cast<JDIMENSION>(skip));
+    JDIMENSION end = static_cast<JDIMENSION>(skip + rows);
+    JSAMPROW batch[ROW_BATCH];
+    while(cinfo.output_scanline < end) {
+        JDIMENSION count = std::min<JDIMENSION>(ROW_BATCH, end - cinfo.output_scanline);
+        for(JDIMENSION i = 0; i < count; i++)
+            batch[i] = dst + (cinfo.output_scanline - static_cast<JDIMENSION>(skip) + i) * bpl;
+        if(!jpeg_read_scanlines(&cinfo, batch, count))
+            break; // truncated; keep what we got, like Qt does
+    }
+    if(cinfo.output_scanline < cinfo.output_height)
+        jpeg_abort_decompress(&cinfo);
+    else
+        jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+// Decodes roi of the image into dst (sized as roi).
+// Columns are cropped via jpeg_crop_scanline(), rows above via jpeg_skip_scanlines(),
+// and decoding stops after the last needed row.
+bool decodeRegion(const QByteArray &data, uchar *dst, qsizetype bpl, QRect roi) {
+    jpeg_decompress_struct cinfo;
+    ErrorManager err;
+    setupErrors(cinfo, err);
+    if(setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, reinterpret_cast<const unsigned char*>(data.constData()), static_cast<unsigned long>(data.size()));
+    QImage::Format format;
+    if(jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK || !setupOutput(cinfo, format)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_start_decompress(&cinfo);
+    // Widened to iMCU boundaries by libjpeg. Chroma upsampling treats the crop
+    // edge as image edge, so keep a small margin to match full decoding.
+    int left = std::max(roi.x() - CROP_MARGIN, 0);
+    int right = std::min(roi.x() + roi.width() + CROP_MARGIN, static_cast<int>(cinfo.output_width));
+    JDIMENSION xoffset = static_cast<JDIMENSION>(left);
+    JDIMENSION width = static_cast<JDIMENSION>(right - left);
+    if(width != cinfo.output_width)
+        jpeg_crop_scanline(&cinfo, &xoffset, &width);
+    int pixelSize = cinfo.output_components;
+    bool direct = (xoffset == static_cast<JDIMENSION>(roi.x()) && width == static_cast<JDIMENSION>(roi.width()));
+    // freed with cinfo
+    JSAMPARRAY rowBuffer = (*cinfo.mem->alloc_sarray)(reinterpret_cast<j_common_ptr>(&cinfo), JPOOL_IMAGE,
+                                                      width * static_cast<JDIMENSION>(pixelSize), ROW_BATCH);
+    if(roi.y() > 0)
+        jpeg_skip_scanlines(&cinfo, static_cast<JDIMENSION>(roi.y()));
+    JDIMENSION end = static_cast<JDIMENSION>(roi.y() + roi.height());
+    JSAMPROW batch[ROW_BATCH];
+    while(cinfo.output_scanline < end) {
+        JDIMENSION line = cinfo.output_scanline - static_cast<JDIMENSION>(roi.y());
+        JDIMENSION count = std::min<JDIMENSION>(ROW_BATCH, end - cinfo.output_scanline);
+        for(JDIMENSION i = 0; i < count; i++)
+            batch[i] = direct ? dst + (line + i) * bpl : rowBuffer[i];
+        count = jpeg_read_scanlines(&cinfo, batch, count);
+        if(!count)
+            break;
+        if(!direct) {
+            qsizetype offset = (roi.x() - static_cast<int>(xoffset)) * pixelSize;
+            for(JDIMENSION i = 0; i < count; i++)
+                memcpy(dst + (line + i) * bpl, rowBuffer[i] + offset, static_cast<size_t>(roi.width() * pixelSize));
+        }
+    }
+    if(cinfo.output_scanline < cinfo.output_height)
+        jpeg_abort_decompress(&cinfo);
+    else
+        jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+// Where things are in a single-scan sequential jpeg with restart markers.
+struct ScanLayout {
+    int width = 0, height = 0;
+    int mcuWidth = 8, mcuHeight = 8;
+    int restartInterval = 0;         // in MCUs
+    bool verticalChroma = false;     // upsampling looks at the neighbour MCU rows
+    qsizetype heightPos = 0;         // height field of SOF
+    qsizetype dataStart = 0;         // entropy-coded data, after SOS
+    qsizetype dataEnd = 0;           // EOI
+    std::vector<qsizetype> restarts; // RSTn marker positions
+};
+
+inline int read16(const uchar *p) {
+    return (p[0] << 8) | p[1];
+}
+
+// Returns false for anything that can't be split (progressive, multi-scan, no restarts...)
+bool parseLayout(const uchar *d, qsizetype size, ScanLayout &l) {
+    if(size < 4 || d[0] != 0xFF || d[1] != 0xD8)
+        return false;
+    int components = 0;
+    qsizetype pos = 2;
+    while(!l.dataStart) {
+        if(pos + 4 > size || d[pos] != 0xFF)
+            return false;
+        uchar marker = d[pos + 1];
+        if(marker == 0xFF) { // fill
+            pos++;
+            continue;
+        }
+        qsizetype len = read16(d + pos + 2);
+        if(len < 2 || pos + 2 + len > size)
+            return false;
+        const uchar *seg = d + pos + 4;
+        if(marker == 0xC0 || marker == 0xC1) { // huffman, sequential
+            if(len < 8)
+                return false;
+            l.heightPos = pos + 5;
+            l.height = read16(seg + 1);
+            l.width = read16(seg + 3);
+            components = seg[5];
+            if(components < 1 || len < 8 + 3 * components)
+                return false;
+            int hMax = 1, vMax = 1;
+            for(int i = 0; i < components; i++) {
+                hMax = std::max(hMax, seg[7 + 3 * i] >> 4);
+                vMax = std::max(vMax, seg[7 + 3 * i] & 15);
+            }
+            // a single component scan is not interleaved; MCU is one block
+            if(components > 1) {
+                l.mcuWidth = 8 * hMax;
+                l.mcuHeight = 8 * vMax;
+                l.verticalChroma = (vMax > 1);
+            }
+        } else if(marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            return false; // progressive, lossless, arithmetic
+        } else if(marker == 0xDD) {
+            if(len < 4)
+                return false;
+            l.restartInterval = read16(seg);
+        } else if(marker == 0xDA) {
+            // must be the only scan, with all components
+            if(!components || seg[0] != components)
+                return false;
+            l.dataStart = pos + 2 + len;
+        } else if(marker == 0xD9) {
+            return false;
+        }
+        pos += 2 + len;
+    }
+    if(!l.restartInterval || l.width <= 0 || l.height <= 0)
+        return false;
+    for(qsizetype i = l.dataStart; i + 1 < size; i++) {
+        if(d[i] != 0xFF || d[i + 1] == 0x00 || d[i + 1] == 0xFF)
+            continue;
+        if(d[i + 1] >= 0xD0 && d[i + 1] <= 0xD7) {
+            l.restarts.push_back(i);
+            i++;
+            continue;
+        }
+        // EOI; anything else (DNL, more scans) we don't handle
+        if(d[i + 1] != 0xD9)
+            return false;
+        l.dataEnd = i;
+        break;
+    }
+    if(!l.dataEnd)
+        return false;
+    qint64 mcus = qint64((l.width + l.mcuWidth - 1) / l.mcuWidth) * ((l.height + l.mcuHeight - 1) / l.mcuHeight);
+    return static_cast<qint64>(l.restarts.size()) == (mcus + l.restartInterval - 1) / l.restartInterval - 1;
+}
+
+// A standalone jpeg: original headers with patched height,
+// entropy data of [start, end) with restart markers renumbered from 0, EOI.
+QByteArray makeStrip(const uchar *d, const ScanLayout &l, qsizetype start, qsizetype end, int height) {
+    QByteArray strip;
+    strip.reserve(static_cast<int>(l.dataStart + (end - start) + 2));
+    strip.append(reinterpret_cast<const char*>(d), static_cast<int>(l.dataStart));
+    strip[static_cast<int>(l.heightPos)] = static_cast<char>(height >> 8);
+    strip[static_cast<int>(l.heightPos + 1)] = static_cast<char>(height & 0xFF);
+    strip.append(reinterpret_cast<const char*>(d + start), static_cast<int>(end - start));
+    char *s = strip.data() + l.dataStart;
+    int restartNum = 0;
+    for(auto r : l.restarts) {
+        if(r < start)
+            continue;
+        if(r >= end)
+            break;
+        s[r - start + 1] = static_cast<char>(0xD0 + (restartNum++ & 7));
+    }
+    strip.append(static_cast<char>(0xFF));
+    strip.append(static_cast<char>(0xD9));
+    return strip;
+}
+
+class StripRunnable : public QRunnable {
+public:
+    StripRunnable(QByteArray _jpeg, uchar *_dst, qsizetype _bpl, int _width, int _skip, int _rows, QSemaphore *_done, QAtomicInt *_failed)
+        : jpeg(_jpeg), dst(_dst), bpl(_bpl), width(_width), skip(_skip), rows(_rows), done(_done), failed(_failed)
+    {
+    }
+    void run() {
+        TRACE_SCOPE("JpegDecoder strip", "decode");
+        if(!decodeRows(jpeg, dst, bpl, width, skip, rows))
+            failed->storeRelease(1);
+        done->release();
+    }
+private:
+    QByteArray jpeg;
+    uchar *dst;
+    qsizetype bpl;
+    int width, skip, rows;
+    QSemaphore *done;
+    QAtomicInt *failed;
+};
+
+// Shared by all loader threads. Never destroyed, so that no threads
+// are being joined during static destruction.
+QThreadPool *stripPool() {
+    static QThreadPool *pool = [] {
+        auto p = new QThreadPool();
+        p->setMaxThreadCount(QThread::idealThreadCount());
+        return p;
+    }();
+    return pool;
+}
+
+// Restart markers reset the decoder (DC predictors, bit buffer), so the data can
+// be cut at any marker which starts an MCU row. Returns false if the file
+// can't be split; nothing is written in that case.
+bool decodeParallel(const QByteArray &data, QImage &image, int threads) {
+    auto d = reinterpret_cast<const uchar*>(data.constData());
+    ScanLayout l;
+    if(!parseLayout(d, data.size(), l))
+        return false;
+    int mcusPerRow = (l.width + l.mcuWidth - 1) / l.mcuWidth;
+    int mcuRows = (l.height + l.mcuHeight - 1) / l.mcuHeight;
+    // MCU rows where a restart interval begins
+    int rowStep = l.restartInterval / std::gcd(l.restartInterval, mcusPerRow);
+    // With vertically subsampled chroma each strip also decodes a restart interval
+    // above and below it, so that the edge rows are interpolated the same way.
+    // Don't let that overhead grow past ~50%.
+    int context = l.verticalChroma ? rowStep : 0;
+    int strips = std::min(threads * STRIPS_PER_THREAD, mcuRows / std::max(rowStep, context * 4));
+    if(strips < 2)
+        return false;
+    std::vector<int> bounds; // in MCU rows
+    for(int i = 0; i < strips; i++) {
+        int row = static_cast<int>(qint64(mcuRows) * i / strips / rowStep * rowStep);
+        if(bounds.empty() || row > bounds.back())
+            bounds.push_back(row);
+    }
+    bounds.push_back(mcuRows);
+    auto segmentStart = [&](int row) {
+        qint64 segment = qint64(row) * mcusPerRow / l.restartInterval;
+        return segment ? l.restarts[static_cast<size_t>(segment - 1)] + 2 : l.dataStart;
+    };
+    auto segmentEnd = [&](int row) {
+        if(row == mcuRows)
+            return l.dataEnd;
+        return l.restarts[static_cast<size_t>(qint64(row) * mcusPerRow / l.restartInterval - 1)];
+    };
+
+    uchar *bits = image.bits();
+    qsizetype bpl = image.bytesPerLine();
+    QSemaphore done;
+    QAtomicInt failed(0);
+    std::vector<std::unique_ptr<StripRunnable>> tasks;
+    for(size_t i = 0; i < bounds.size() - 1; i++) {
+        int first = std::max(bounds[i] - context, 0);
+        int last = std::min(bounds[i + 1] + context, mcuRows);
+        int y0 = bounds[i] * l.mcuHeight;
+        int rows = std::min(bounds[i + 1] * l.mcuHeight, l.height) - y0;
+        int height = std::min(last * l.mcuHeight, l.height) - first * l.mcuHeight;
+        QByteArray strip = makeStrip(d, l, segmentStart(first), segmentEnd(last), height);
+        tasks.emplace_back(new StripRunnable(strip, bits + y0 * bpl, bpl, l.width,
+                                             (bounds[i] - first) * l.mcuHeight, rows, &done, &failed));
+        tasks.back()->setAutoDelete(false);
+    }
+    // this thread takes the first strip
+    for(size_t i = 1; i < tasks.size(); i++)
+        stripPool()->start(tasks[i].get());
+    tasks[0]->run();
+    done.acquire(static_cast<int>(tasks.size()));
+    if(failed.loadAcquire()) {
+        qDebug() << "[JpegDecoder] parallel decoding failed, retrying serially";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool JpegDecoder::readHeader(const QByteArray &data, QSize &size, QImage::Format &format) {
+    jpeg_decompress_struct cinfo;
+    ErrorManager err;
+    setupErrors(cinfo, err);
+    if(setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, reinterpret_cast<const unsigned char*>(data.constData()), static_cast<unsigned long>(data.size()));
+    bool ok = (jpeg_read_header(&cinfo, TRUE) == JPEG_HEADER_OK) && setupOutput(cinfo, format);
+    size = QSize(static_cast<int>(cinfo.image_width), static_cast<int>(cinfo.image_height));
+    jpeg_destroy_decompress(&cinfo);
+    return ok && !size.isEmpty();
+}
+
+bool JpegDecoder::read(const QByteArray &data, QImage &image, QRect roi, int maxThreads) {
+    TRACE_SCOPE("JpegDecoder::read", "decode");
+    QSize size;
+    QImage::Format format;
+    if(!readHeader(data, size, format))
+        return false;
+    QRect full(QPoint(0, 0), size);
+    roi = roi.isNull() ? full : roi.intersected(full);
+    if(roi.isEmpty())
+        return false;
+    if(image.size() != roi.size() || image.format() != format)
+        image = QImage(roi.size(), format);
+    if(image.isNull())
+        return false;
+    if(maxThreads <= 0)
+        maxThreads = QThread::idealThreadCount();
+    if(roi == full && maxThreads > 1 && qint64(size.width()) * size.height() >= PARALLEL_MIN_PIXELS) {
+        if(decodeParallel(data, image, maxThreads))
+            return true;
+    }
+    return decodeRegion(data, image.bits(), image.bytesPerLine(), roi);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QImage>
+#include <QByteArray>
+#include <QRect>
+#include <QDebug>
+
+// JPEG decoding via libjpeg-turbo, used instead of QImageReader when built with it.
+//
+// - Files with restart markers are split into strips which are decoded
+//   in parallel. Restart intervals reset the entropy decoder state, so each
+//   strip can be decoded as a standalone jpeg.
+// - A region can be decoded while skipping most of the work for the rest.
+// - Pixels are written straight into the image in its final format.
+//
+// Only YCbCr/RGB and grayscale files are handled; for anything else
+// (cmyk etc.) read() returns false and the caller should use Qt.
+class JpegDecoder {
+public:
+    // Size and format read() would produce, without decoding.
+    static bool readHeader(const QByteArray &data, QSize &size, QImage::Format &format);
+    // If the image already has the right size and format, its buffer is reused.
+    // roi: decode only this part (clipped to the image); null rect for everything.
+    // maxThreads: 0 to use all cores.
+    static bool read(const QByteArray &data, QImage &image, QRect roi = QRect(), int maxThreads = 0);
+};
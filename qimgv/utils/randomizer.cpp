@@ -77,3 +77,10 @@ int Randomizer::prev() {
     currentIndex--;
     return vec[currentIndex];
 }
+
+std::vector<int> Randomizer::upcoming(int count) const {
+    std::vector<int> items;
+    for(int i = currentIndex + 1; i < static_cast<int>(vec.size()) && static_cast<int>(items.size()) < count; i++)
+        items.push_back(vec[i]);
+    return items;
+}
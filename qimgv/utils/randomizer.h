@@ -17,6 +17,8 @@ public:
     void setCount(int _count);
     int next();
     int prev();
+    // what next() would return, without advancing or reshuffling
+    std::vector<int> upcoming(int count) const;
 
     void shuffle();
     void print();
@@ -0,0 +1,102 @@
+#include "tracer.h"
+#include <QFile>
+#include <QThread>
+#include <QCoreApplication>
+#include <QDebug>
+
+// per thread; when full the oldest events are dropped
+#define TRACE_BUFFER_EVENTS 16384
+
+std::atomic<bool> Tracer::active(false);
+QElapsedTimer Tracer::clock;
+QString Tracer::filePath;
+QMutex Tracer::buffersMutex;
+std::list<Tracer::ThreadBuffer> Tracer::buffers;
+QList<Tracer::ThreadBuffer*> Tracer::freeBuffers;
+QMap<int, QString> Tracer::threadNames;
+
+// hands the buffer over to the next new thread when this one exits
+// (pool threads come and go; their events stay)
+struct Tracer::BufferHolder {
+    ThreadBuffer *buffer = nullptr;
+    ~BufferHolder() {
+        if(buffer) {
+            QMutexLocker lock(&buffersMutex);
+            freeBuffers.append(buffer);
+        }
+    }
+};
+
+void Tracer::start(QString path) {
+    filePath = path;
+    clock.start();
+    active = true;
+    qDebug() << "[Tracer] recording to" << path;
+}
+
+Tracer::ThreadBuffer *Tracer::threadBuffer() {
+    thread_local BufferHolder holder;
+    if(!holder.buffer) {
+        QMutexLocker lock(&buffersMutex);
+        if(freeBuffers.isEmpty()) {
+            buffers.emplace_back();
+            holder.buffer = &buffers.back();
+            holder.buffer->events.resize(TRACE_BUFFER_EVENTS);
+        } else {
+            holder.buffer = freeBuffers.takeLast();
+        }
+        int tid = threadNames.count() + 1;
+        QThread *thread = QThread::currentThread();
+        QString name;
+        if(qApp && thread == qApp->thread())
+            name = "main";
+        else
+            name = (thread->objectName().isEmpty() ? "thread" : thread->objectName()) + " " + QString::number(tid);
+        threadNames.insert(tid, name.replace("\"", "'"));
+        QMutexLocker bufferLock(&holder.buffer->mutex);
+        holder.buffer->tid = tid;
+    }
+    return holder.buffer;
+}
+
+void Tracer::record(const char *name, const char *category, qint64 begin, qint64 end) {
+    ThreadBuffer *buffer = threadBuffer();
+    QMutexLocker lock(&buffer->mutex);
+    buffer->events[buffer->count % buffer->events.size()] = { name, category, begin, end, buffer->tid };
+    buffer->count++;
+}
+
+void Tracer::finish() {
+    if(!active)
+        return;
+    active = false;
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "[Tracer] could not open" << filePath;
+        return;
+    }
+    QByteArray out("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    auto append = [&](const QString &event) {
+        out.append(first ? "\n" : ",\n");
+        out.append(event.toUtf8());
+        first = false;
+    };
+    QMutexLocker lock(&buffersMutex);
+    for(auto it = threadNames.constBegin(); it != threadNames.constEnd(); ++it)
+        append(QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}").arg(it.key()).arg(it.value()));
+    size_t written = 0;
+    for(auto &buffer : buffers) {
+        QMutexLocker bufferLock(&buffer.mutex);
+        size_t size = buffer.events.size();
+        for(size_t i = (buffer.count > size) ? buffer.count - size : 0; i < buffer.count; i++) {
+            const Event &e = buffer.events[i % size];
+            append(QString::asprintf("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                                     e.name, e.category, e.begin / 1000.0, (e.end - e.begin) / 1000.0, e.tid));
+            written++;
+        }
+    }
+    out.append("\n]}\n");
+    file.write(out);
+    qDebug() << "[Tracer]" << written << "events written to" << filePath;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Timing spans written as Chrome trace-event json,
+// viewable in ui.perfetto.dev or chrome://tracing.
+//
+// Built with -DTRACING=ON, recorded when started with --trace=file.json.
+// Otherwise TRACE_SCOPE expands to nothing.
+//
+// Usage:
+//     TRACE_SCOPE("decode", "loader");
+// records the time until the end of the enclosing scope.
+// Name and category must be string literals.
+
+#ifdef USE_TRACING
+
+#include <QString>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+#include <atomic>
+#include <vector>
+#include <list>
+
+class Tracer {
+public:
+    // start recording; the file is written by finish()
+    static void start(QString path);
+    static void finish();
+    static bool enabled() {
+        return active.load(std::memory_order_relaxed);
+    }
+    // ns since start()
+    static qint64 now() {
+        return clock.nsecsElapsed();
+    }
+    static void record(const char *name, const char *category, qint64 begin, qint64 end);
+
+private:
+    struct Event {
+        const char *name;
+        const char *category;
+        qint64 begin, end;
+        int tid;
+    };
+    // written by one thread at a time, read by finish()
+    // oldest events are overwritten when full
+    struct ThreadBuffer {
+        QMutex mutex;
+        std::vector<Event> events;
+        size_t count = 0;
+        int tid = 0;
+    };
+    struct BufferHolder;
+    static ThreadBuffer *threadBuffer();
+
+    static std::atomic<bool> active;
+    static QElapsedTimer clock;
+    static QString filePath;
+    static QMutex buffersMutex;
+    static std::list<ThreadBuffer> buffers;
+    // of exited threads
+    static QList<ThreadBuffer*> freeBuffers;
+    static QMap<int, QString> threadNames;
+};
+
+class TraceSpan {
+public:
+    TraceSpan(const char *_name, const char *_category)
+        : name(_name),
+          category(_category),
+          begin(Tracer::enabled() ? Tracer::now() : -1)
+    {
+    }
+    ~TraceSpan() {
+        if(begin >= 0)
+            Tracer::record(name, category, begin, Tracer::now());
+    }
+private:
+    const char *name, *category;
+    qint64 begin;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name, category) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name, category)
+
+#else
+
+#define TRACE_SCOPE(name, category)
+
+#endif